@@ -4,6 +4,26 @@
 #define WIDTH 800
 #define HEIGHT 600
 
+#define GAME_MAX_STEPS 5
+#define GAME_FRAME_RATE 0
+#define GAME_FRAME_SMOOTHING 0.5f
+
+#define RESOURCE_ARCHIVE_FILEPATH "../res/demo.narc"
+#define RESOURCE_TEXTURE_BUDGET (32 * 1024 * 1024)
+#define RESOURCE_IMAGE_CACHE_DIRECTORY "../cache"
+#define RESOURCE_COLLECT_ENTRIES 64
+#define RESOURCE_HOT_RELOAD false
+
+#define STATE_PROFILING false
+#define STATE_PROFILE_FILEPATH "../profile.json"
+#define STATE_PROFILE_FRAMES 120
+
+#define ACTION_CLICK "Click"
+#define ACTION_LEFT "Left"
+#define ACTION_RIGHT "Right"
+#define ACTION_UP "Up"
+#define ACTION_DOWN "Down"
+
 #define SPLASH_STATE_SHOW_TIME 1.0
 #define SPLASH_SCENE_BACKGROUND_FILEPATH "../res/states/splash/background.png"
 
@@ -11,7 +31,6 @@
 #define MAIN_MENU_BACKGROUND_FILEPATH "../res/states/main_menu/background.png"
 #define MAIN_MENU_PLAY_BUTTON_FILEPATH "../res/states/main_menu/play.png"
 
-#define GAME_LOOP_POPUP_SHOW_TIME 0.3
 #define GAME_LOOP_HEALTH_BAR_TIME 0.1
 #define GAME_LOOP_BACKGROUND_FILEPATH "../res/states/game_loop/background.png"
 #define GAME_LOOP_POPUP_BUTTON_FILEPATH "../res/states/game_loop/popup.png"
@@ -22,11 +41,13 @@
 #define GAME_LOOP_HEALTH_BAR_BACKGROUND_FILEPATH "../res/states/game_loop/health_bar_background.png"
 #define GAME_LOOP_PARTICLES_BUTTON_FILEPATH "../res/states/game_loop/particles.png"
 #define GAME_LOOP_NAME_FONT_FILEPATH "../res/states/game_loop/name_font.otf"
+#define GAME_LOOP_ANIMATED_SPRITE_FILEPATH "../res/rpg.png"
 
 #define PAUSE_MENU_TITLE_FILEPATH "../res/states/pause_menu/title.png"
 #define PAUSE_MENU_BACKGROUND_FILEPATH "../res/states/pause_menu/background.png"
 #define PAUSE_MENU_RESUME_BUTTON_FILEPATH "../res/states/pause_menu/resume.png"
 #define PAUSE_MENU_HOME_BUTTON_FILEPATH "../res/states/pause_menu/home.png"
+#define PAUSE_MENU_BACKGROUND_ALPHA 192
 
 #endif
 
@@ -1,49 +1,62 @@
 #include "game.hpp"
 #include "states/splash/splash.hpp"
+#include <fstream>
 
 game::game(int width, int height, std::string title)
 	: _dt(1.0f / 60.0f)
-	, _clock()
+	, _run_loop(_dt, nengine::nrun_loop::nrun_mode::SINGLE)
 	, _data(std::make_shared<game_data>())
 {
 	_data->window.create(sf::VideoMode(width, height), title, sf::Style::Close | sf::Style::Titlebar);
 	_data->window.setVerticalSyncEnabled(true);
+	_data->state_manager.set_frame_cache(_data->window.getSize()); // paused states are drawn once into a texture instead of every frame
+	_data->state_manager.set_profiling(STATE_PROFILING); // times handle(), update() and draw() of every state
+	_data->resource_manager.mount_archive(RESOURCE_ARCHIVE_FILEPATH); // falls back to the loose files if the archive was not packed
+	_data->resource_manager.set_texture_budget(RESOURCE_TEXTURE_BUDGET); // keeps unused textures around for quick state changes
+	_data->resource_manager.set_image_cache(RESOURCE_IMAGE_CACHE_DIRECTORY); // decoded textures are reused across starts
+	_data->resource_manager.set_hot_reload(RESOURCE_HOT_RELOAD); // if enabled, edited textures show up without a restart
+	_data->input_manager.add_bind(ACTION_CLICK, sf::Mouse::Left);
+	_data->input_manager.add_bind(ACTION_LEFT, sf::Keyboard::A);
+	_data->input_manager.add_bind(ACTION_LEFT, sf::Keyboard::Left); // every action also listens to the arrow keys
+	_data->input_manager.add_bind(ACTION_RIGHT, sf::Keyboard::D);
+	_data->input_manager.add_bind(ACTION_RIGHT, sf::Keyboard::Right);
+	_data->input_manager.add_bind(ACTION_UP, sf::Keyboard::W);
+	_data->input_manager.add_bind(ACTION_UP, sf::Keyboard::Up);
+	_data->input_manager.add_bind(ACTION_DOWN, sf::Keyboard::S);
+	_data->input_manager.add_bind(ACTION_DOWN, sf::Keyboard::Down);
 	_data->state_manager.add(std::unique_ptr<nstate>(new splash(_data)), true);
 }
 
 auto game::run() -> void
 {
-	float new_time = 0.0;
-	float frame_time = 0.0;
-	float current_time = _clock.getElapsedTime().asSeconds();
-	float accumulator = 0.0;
 	_data->particle_system.set_gravity(0.1, 0.1);
 	_data->particle_system.set_max(2000);
+	_run_loop.set_max_steps(GAME_MAX_STEPS); // a stall drops steps instead of bursting through them
+	_run_loop.set_frame_rate(GAME_FRAME_RATE); // 0 leaves the pacing to vsync
+	_run_loop.set_smoothing(GAME_FRAME_SMOOTHING);
+	_run_loop.start([this](float dt, game_frame&)
+	{
+		_data->state_manager.handle();
+		_data->state_manager.update(dt);
+	});
 	while(_data->window.isOpen())
 	{
 		_data->state_manager.process();
 		
-		_data->resource_manager.clr_unused();
-		
-		new_time = _clock.getElapsedTime().asSeconds();
-		frame_time = new_time - current_time;
-		
-		if(frame_time > 0.25)
-		{
-			frame_time = 0.25;
-		}
-		
-		current_time = new_time;
-		accumulator += frame_time;
+		_data->resource_manager.process();
+		_data->resource_manager.clr_unused(RESOURCE_COLLECT_ENTRIES); // flat cost per frame, resumes where the last frame stopped
 		
-		while(accumulator >= _dt)
+		_run_loop.render([this](game_frame const&, game_frame const&, float alpha)
 		{
-			_data->state_manager.get()->handle();
-			_data->state_manager.get()->update(_dt);
-			
-			accumulator -= _dt;
-		}
-		
-		_data->state_manager.get()->draw(accumulator);
+			_data->state_manager.draw(alpha * _dt);
+		});
+		_run_loop.pace();
+	}
+	_run_loop.stop();
+	
+	if(STATE_PROFILING)
+	{
+		std::ofstream trace(STATE_PROFILE_FILEPATH); // open it in chrome://tracing
+		_data->state_manager.dump_trace(trace, STATE_PROFILE_FRAMES);
 	}
 }
@@ -9,12 +9,14 @@
 #include "../../nparticle_system/nparticle_system.hpp"
 #include "../../nresource_manager/nresource_wrapper.hpp"
 #include "../../nstate_manager/nstate_manager.hpp"
+#include "../../nrun_loop/nrun_loop.hpp"
 
 using namespace nengine;
 using namespace nengine::ninput_manager;
 using namespace nengine::nparticle_system;
 using namespace nengine::nresource_manager;
 using namespace nengine::nstate_manager;
+using namespace nengine::nrun_loop;
 
 struct game_data
 {
@@ -25,6 +27,11 @@ struct game_data
 	nengine::nstate_manager::nstate_manager state_manager;
 };
 
+struct game_frame
+{
+	// the states draw their own members, so a frame carries nothing
+};
+
 class game
 {
 	public:
@@ -32,7 +39,7 @@ class game
 		auto run() -> void;
 	private:
 		const float _dt;
-		sf::Clock _clock;
+		nengine::nrun_loop::nrun_loop<game_frame> _run_loop;
 		std::shared_ptr<game_data> _data;
 };
 
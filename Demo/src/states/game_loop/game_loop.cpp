@@ -1,12 +1,17 @@
 #include "game_loop.hpp"
 #include "../pause_menu/pause_menu.hpp"
 #include "../../definitions.hpp"
+#include <chrono>
 #include <sstream>
 
 game_loop::game_loop(std::shared_ptr<game_data> data)
 	: _data(data)
+	, _click(data->input_manager.get_action(ACTION_CLICK))
+	, _left(data->input_manager.get_action(ACTION_LEFT))
+	, _right(data->input_manager.get_action(ACTION_RIGHT))
+	, _up(data->input_manager.get_action(ACTION_UP))
+	, _down(data->input_manager.get_action(ACTION_DOWN))
 	, _clock()
-	, _popup_clock()
 	, _health_bar_clock()
 	, _health_bar_cnt(1)
 	, _show_popup(false)
@@ -19,31 +24,46 @@ game_loop::game_loop(std::shared_ptr<game_data> data)
 	, _gui_layer()
 	, _popup_layer()
 	, _textures()
+	, _regions()
 	, _animated()
+	, _manifest()
+	, _loaded()
 {
+	_manifest.add_texture("Game Loop Background", GAME_LOOP_BACKGROUND_FILEPATH);
+	_manifest.add_texture("Game Loop Popup Button", GAME_LOOP_POPUP_BUTTON_FILEPATH);
+	_manifest.add_texture_atlas("Game Loop Popup Background Button", GAME_LOOP_POPUP_BACKGROUND_BUTTON_FILEPATH);
+	_manifest.add_texture_atlas("Game Loop Popup Button Menu", GAME_LOOP_POPUP_MENU_BUTTON_FILEPATH);
+	_manifest.add_texture_atlas("Game Loop Popup Button Close", GAME_LOOP_POPUP_CLOSE_BUTTON_FILEPATH);
+	_manifest.add_texture("Game Loop Health Bar", GAME_LOOP_HEALTH_BAR_FILEPATH);
+	_manifest.add_texture("Game Loop Health Bar Background", GAME_LOOP_HEALTH_BAR_BACKGROUND_FILEPATH);
+	_manifest.add_texture("Game Loop Particles", GAME_LOOP_PARTICLES_BUTTON_FILEPATH);
+	_manifest.add_font("Game Loop Name Font", GAME_LOOP_NAME_FONT_FILEPATH, nengine::nresource_manager::nglyph_set().add_characters("Fluriman Hansson").add_size(20).add_outline(1)); // warmed for the nameplate
+	_manifest.add_texture("Animated Sprite", GAME_LOOP_ANIMATED_SPRITE_FILEPATH);
+}
+
+auto game_loop::preload() -> void
+{
+	_loaded = _data->resource_manager.preload(_manifest); // runs while the previous state is still shown
+}
+
+auto game_loop::ready() -> bool
+{
+	return (!_loaded.valid() || (_loaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready));
 }
 
 auto game_loop::init() -> void
 {
-	_data->resource_manager.load_texture("Game Loop Background", GAME_LOOP_BACKGROUND_FILEPATH);
-	_data->resource_manager.load_texture("Game Loop Popup Button", GAME_LOOP_POPUP_BUTTON_FILEPATH);
-	_data->resource_manager.load_texture("Game Loop Popup Background Button", GAME_LOOP_POPUP_BACKGROUND_BUTTON_FILEPATH);
-	_data->resource_manager.load_texture("Game Loop Popup Button Menu", GAME_LOOP_POPUP_MENU_BUTTON_FILEPATH);
-	_data->resource_manager.load_texture("Game Loop Popup Button Close", GAME_LOOP_POPUP_CLOSE_BUTTON_FILEPATH);
-	_data->resource_manager.load_texture("Game Loop Health Bar", GAME_LOOP_HEALTH_BAR_FILEPATH);
-	_data->resource_manager.load_texture("Game Loop Health Bar Background", GAME_LOOP_HEALTH_BAR_BACKGROUND_FILEPATH);
-	_data->resource_manager.load_texture("Game Loop Particles", GAME_LOOP_PARTICLES_BUTTON_FILEPATH);
+	_data->resource_manager.load(_manifest); // only loads what preload() did not finish
 	
 	_textures.push_back(_data->resource_manager.get_texture_p("Game Loop Background"));
 	_textures.push_back(_data->resource_manager.get_texture_p("Game Loop Popup Button"));
-	_textures.push_back(_data->resource_manager.get_texture_p("Game Loop Popup Background Button"));
-	_textures.push_back(_data->resource_manager.get_texture_p("Game Loop Popup Button Menu"));
-	_textures.push_back(_data->resource_manager.get_texture_p("Game Loop Popup Button Close"));
 	_textures.push_back(_data->resource_manager.get_texture_p("Game Loop Health Bar"));
 	_textures.push_back(_data->resource_manager.get_texture_p("Game Loop Health Bar Background"));
 	_textures.push_back(_data->resource_manager.get_texture_p("Game Loop Particles"));
 	
-	_data->resource_manager.load_font("Game Loop Name Font", GAME_LOOP_NAME_FONT_FILEPATH);
+	_regions.push_back(_data->resource_manager.get_texture_region("Game Loop Popup Background Button"));
+	_regions.push_back(_data->resource_manager.get_texture_region("Game Loop Popup Button Menu"));
+	_regions.push_back(_data->resource_manager.get_texture_region("Game Loop Popup Button Close"));
 	
 	_background.setTexture(_data->resource_manager.get_texture("Game Loop Background"));
 	_popup.setTexture(_data->resource_manager.get_texture("Game Loop Popup Button"));
@@ -57,18 +77,16 @@ auto game_loop::init() -> void
 	_health_bar_background.setPosition(250.0, 10.0);
 	_particles.setPosition(((_data->window.getSize().x / 2.0) - (_particles.getGlobalBounds().width / 2.0)), ((_data->window.getSize().y / 2.0) - (_particles.getGlobalBounds().height / 2.0)));
 	
-	sf::Sprite _popup_background;
-	_popup_background.setTexture(_data->resource_manager.get_texture("Game Loop Popup Background Button"));
-	sf::Sprite _popup_button;
-	_popup_button.setTexture(_data->resource_manager.get_texture("Game Loop Popup Button Menu"));
+	auto popup_background = _data->resource_manager.get_texture_region("Game Loop Popup Background Button");
+	auto popup_menu = _data->resource_manager.get_texture_region("Game Loop Popup Button Menu");
+	auto popup_close = _data->resource_manager.get_texture_region("Game Loop Popup Button Close");
 	
 	_gui_layer.add_text("Character Name", 10.0, 10.0, _data->resource_manager.get_font_p("Game Loop Name Font"), "Fluriman Hansson", 20, sf::Color::White, 1, sf::Color::Black);
 	
-	_popup_layer.add_sprite("Popup Background", 0.0, _data->window.getSize().y - _popup_background.getGlobalBounds().height - _popup.getGlobalBounds().height, _data->resource_manager.get_texture_p("Game Loop Popup Background Button"));
-	_popup_layer.add_sprite("Popup Button Close", 1.0, _data->window.getSize().y - _popup_layer.get_sprite("Popup Background").getGlobalBounds().height - _popup.getGlobalBounds().height + _popup_button.getGlobalBounds().height + 2.0, _data->resource_manager.get_texture_p("Game Loop Popup Button Close"));
-	_popup_layer.add_sprite("Popup Button Menu", 1.0, _data->window.getSize().y - _popup_layer.get_sprite("Popup Background").getGlobalBounds().height - _popup.getGlobalBounds().height + 2.0, _data->resource_manager.get_texture_p("Game Loop Popup Button Menu"));
+	_popup_layer.add_sprite("Popup Background", 0.0, _data->window.getSize().y - popup_background->_rect.height - _popup.getGlobalBounds().height, popup_background->_texture, popup_background->_rect);
+	_popup_layer.add_sprite("Popup Button Close", 1.0, _data->window.getSize().y - _popup_layer.get_sprite("Popup Background").getGlobalBounds().height - _popup.getGlobalBounds().height + popup_menu->_rect.height + 2.0, popup_close->_texture, popup_close->_rect);
+	_popup_layer.add_sprite("Popup Button Menu", 1.0, _data->window.getSize().y - _popup_layer.get_sprite("Popup Background").getGlobalBounds().height - _popup.getGlobalBounds().height + 2.0, popup_menu->_texture, popup_menu->_rect);
 	
-	_data->resource_manager.load_texture("Animated Sprite", "../res/rpg.png");
 	_animated.add("still", 4,_data->resource_manager.get_texture_p("Animated Sprite"), 0.2f, 0, 0, 1, 51, 51); // row 1
 	_animated.add("down", 4, _data->resource_manager.get_texture_p("Animated Sprite"),  0.2f, 0, 0, 2, 51, 51); // row 2
 	_animated.add("left", 4, _data->resource_manager.get_texture_p("Animated Sprite"), 0.2f, 0, 0, 3, 51, 51); // row 3
@@ -94,35 +112,32 @@ auto game_loop::handle() -> void
 		sf::Event event;
 		while(_data->window.pollEvent(event))
 		{
+			_data->input_manager.feed(event);
 			if(event.type == sf::Event::Closed)
 			{
 				_data->window.close();
 			}
 		}
-		if(_data->input_manager.clicked(_popup, sf::Mouse::Left, _data->window))
+		_data->input_manager.next_frame(); // every query below reads this frame
+		bool click = _data->input_manager.action_pressed(_click); // once per click, no matter how long it is held
+		if(click && _data->input_manager.clicked(_popup, sf::Mouse::Left, _data->window))
 		{
-			if(_popup_clock.getElapsedTime().asSeconds() > GAME_LOOP_POPUP_SHOW_TIME) // timer to cope with SFMLs multiple events per second
-			{
-				_show_popup = !_show_popup;
-				_popup_clock.restart();
-			}
+			_show_popup = !_show_popup;
+			click = false; // the click is used up
 		}
 		if(_data->input_manager.clicked(_particles, sf::Mouse::Left, _data->window))
 		{
-			_data->particle_system.add(1, 100.0, 1.0, sf::Color::Red, sf::Mouse::getPosition(_data->window).x, sf::Mouse::getPosition(_data->window).y, 5.0, 0.0);
+			_data->particle_system.add(1, 100.0, 1.0, sf::Color::Red, _data->input_manager.get_mouse_position(_data->window).x, _data->input_manager.get_mouse_position(_data->window).y, 5.0, 0.0);
 		}
-		if(_show_popup)
+		if(_show_popup && click)
 		{
-			if(_popup_clock.getElapsedTime().asSeconds() > GAME_LOOP_POPUP_SHOW_TIME) // timer to cope with SFMLs multiple events per second)
+			if(_data->input_manager.clicked(_popup_layer.get_sprite("Popup Button Menu"), sf::Mouse::Left, _data->window))
+			{
+				_data->state_manager.add(std::unique_ptr<nstate>(new pause_menu(_data)), false);
+			}
+			if(_data->input_manager.clicked(_popup_layer.get_sprite("Popup Button Close"), sf::Mouse::Left, _data->window))
 			{
-				if(_data->input_manager.clicked(_popup_layer.get_sprite("Popup Button Menu"), sf::Mouse::Left, _data->window))
-				{
-					_data->state_manager.add(std::unique_ptr<nstate>(new pause_menu(_data)), false);
-				}
-				if(_data->input_manager.clicked(_popup_layer.get_sprite("Popup Button Close"), sf::Mouse::Left, _data->window))
-				{
-					_data->window.close();
-				}
+				_data->window.close();
 			}
 		}
 		
@@ -131,19 +146,19 @@ auto game_loop::handle() -> void
 		bool right = false;
 		bool down = false;
 		
-		if(sf::Keyboard::isKeyPressed(sf::Keyboard::A))
+		if(_data->input_manager.action_held(_left))
 		{
 			left = true;
 		}
-		if(sf::Keyboard::isKeyPressed(sf::Keyboard::D))
+		if(_data->input_manager.action_held(_right))
 		{
 			right = true;
 		}
-		if(sf::Keyboard::isKeyPressed(sf::Keyboard::W))
+		if(_data->input_manager.action_held(_up))
 		{
 			up = true;
 		}
-		if(sf::Keyboard::isKeyPressed(sf::Keyboard::S))
+		if(_data->input_manager.action_held(_down))
 		{
 			down = true;
 		}
@@ -194,19 +209,24 @@ auto game_loop::draw(float dt) -> void
 {
 	_data->window.setActive(true);
 	_data->window.clear(sf::Color::Black);
-	_data->window.draw(_background);
-	_data->window.draw(_popup);
-	_data->window.draw(_gui_layer);
+	capture(_data->window);
+	_data->window.display();
+	_data->window.setActive(false);
+}
+
+auto game_loop::capture(sf::RenderTarget& target) -> void
+{
+	target.draw(_background);
+	target.draw(_popup);
+	target.draw(_gui_layer);
 	if(_show_popup)
 	{
-		_data->window.draw(_popup_layer);
+		target.draw(_popup_layer);
 	}
-	_data->window.draw(_health_bar_background);
-	_data->window.draw(_health_bar);
-	_data->window.draw(_particles);
-	_data->window.draw(_data->particle_system);
-	_data->window.draw(_animated);
-	_data->window.display();
-	_data->window.setActive(false);
+	target.draw(_health_bar_background);
+	target.draw(_health_bar);
+	target.draw(_particles);
+	target.draw(_data->particle_system);
+	target.draw(_animated);
 }
 
@@ -4,6 +4,7 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include <memory>
+#include <future>
 #include "../../../../nlayer/nlayer.hpp"
 #include "../../../../nstate_manager/nstate.hpp"
 #include "../../../../nanimator/nanimator.hpp"
@@ -14,16 +15,23 @@ class game_loop : public nengine::nstate_manager::nstate
 {
 	public:
 		game_loop(std::shared_ptr<game_data> data);
+		auto preload() -> void;
+		auto ready() -> bool;
 		auto init() -> void;
 		auto pause() -> void;
 		auto resume() -> void;
 		auto handle() -> void;
 		auto update(float dt) -> void;
 		auto draw(float dt) -> void;
+		auto capture(sf::RenderTarget& target) -> void;
 	private:
 		std::shared_ptr<game_data> _data;
+		nengine::ninput_manager::naction _click;
+		nengine::ninput_manager::naction _left;
+		nengine::ninput_manager::naction _right;
+		nengine::ninput_manager::naction _up;
+		nengine::ninput_manager::naction _down;
 		sf::Clock _clock;
-		sf::Clock _popup_clock;
 		sf::Clock _health_bar_clock;
 		unsigned int _health_bar_cnt;
 		bool _show_popup;
@@ -36,7 +44,10 @@ class game_loop : public nengine::nstate_manager::nstate
 		sf::Sprite _particles;
 		bool _running;
 		std::vector<std::shared_ptr<const sf::Texture>> _textures;
+		std::vector<std::shared_ptr<const nengine::nresource_manager::ntexture_region>> _regions;
 		nengine::nanimator::nanimated_sprite _animated;
+		nengine::nresource_manager::nmanifest _manifest;
+		std::shared_future<bool> _loaded;
 };
 
 #endif
@@ -1,6 +1,7 @@
 #include "main_menu.hpp"
 #include "../game_loop/game_loop.hpp"
 #include "../../definitions.hpp"
+#include <chrono>
 #include <sstream>
 
 main_menu::main_menu(std::shared_ptr<game_data> data)
@@ -9,15 +10,29 @@ main_menu::main_menu(std::shared_ptr<game_data> data)
 	, _title()
 	, _background()
 	, _play_button()
+	, _hits()
 	, _textures()
+	, _manifest()
+	, _loaded()
 {
+	_manifest.add_texture("Main Menu Title", MAIN_MENU_TITLE_FILEPATH);
+	_manifest.add_texture("Main Menu Background", MAIN_MENU_BACKGROUND_FILEPATH);
+	_manifest.add_texture("Main Menu Play Button", MAIN_MENU_PLAY_BUTTON_FILEPATH);
+}
+
+auto main_menu::preload() -> void
+{
+	_loaded = _data->resource_manager.preload(_manifest); // runs while the previous state is still shown
+}
+
+auto main_menu::ready() -> bool
+{
+	return (!_loaded.valid() || (_loaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready));
 }
 
 auto main_menu::init() -> void
 {
-	_data->resource_manager.load_texture("Main Menu Title", MAIN_MENU_TITLE_FILEPATH);
-	_data->resource_manager.load_texture("Main Menu Background", MAIN_MENU_BACKGROUND_FILEPATH);
-	_data->resource_manager.load_texture("Main Menu Play Button", MAIN_MENU_PLAY_BUTTON_FILEPATH);
+	_data->resource_manager.load(_manifest); // only loads what preload() did not finish
 	
 	_textures.push_back(_data->resource_manager.get_texture_p("Main Menu Title"));
 	_textures.push_back(_data->resource_manager.get_texture_p("Main Menu Background"));
@@ -31,6 +46,13 @@ auto main_menu::init() -> void
 	_background.setPosition(0.0, 0.0);
 	_play_button.setPosition(((_data->window.getSize().x / 2.0) - (_play_button.getGlobalBounds().width / 2.0)), ((_data->window.getSize().y / 2.0) - (_play_button.getGlobalBounds().height / 2.0)));
 	
+	_hits.add(_play_button, 0, [this](sf::Mouse::Button button, sf::Vector2i const&)
+	{
+		if(button == sf::Mouse::Left)
+		{
+			_data->state_manager.add(std::unique_ptr<nstate>(new game_loop(_data)), true);
+		}
+	});
 }
 
 auto main_menu::pause() -> void
@@ -46,15 +68,14 @@ auto main_menu::handle() -> void
 	sf::Event event;
 	while(_data->window.pollEvent(event))
 	{
+		_data->input_manager.feed(event);
 		if(event.type == sf::Event::Closed)
 		{
 			_data->window.close();
 		}
-		if(_data->input_manager.clicked(_play_button, sf::Mouse::Left, _data->window))
-		{
-			_data->state_manager.add(std::unique_ptr<nstate>(new game_loop(_data)), true);
-		}
 	}
+	_data->input_manager.next_frame(); // every query below reads this frame
+	_hits.dispatch(_data->input_manager.get_frame()); // once per click, holding the button does not request the game loop again
 }
 
 auto main_menu::update(float dt) -> void
@@ -4,7 +4,9 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include <memory>
+#include <future>
 #include "../../../../nstate_manager/nstate.hpp"
+#include "../../../../ninput_manager/nhit_registry.hpp"
 #include "../../definitions.hpp"
 #include "../../game.hpp"
 
@@ -12,6 +14,8 @@ class main_menu : public nengine::nstate_manager::nstate
 {
 	public:
 		main_menu(std::shared_ptr<game_data> data);
+		auto preload() -> void;
+		auto ready() -> bool;
 		auto init() -> void;
 		auto pause() -> void;
 		auto resume() -> void;
@@ -24,7 +28,10 @@ class main_menu : public nengine::nstate_manager::nstate
 		sf::Sprite _title;
 		sf::Sprite _background;
 		sf::Sprite _play_button;
+		nengine::ninput_manager::nhit_registry _hits;
 		std::vector<std::shared_ptr<const sf::Texture>> _textures;
+		nengine::nresource_manager::nmanifest _manifest;
+		std::shared_future<bool> _loaded;
 };
 
 #endif
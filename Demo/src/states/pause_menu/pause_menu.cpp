@@ -1,6 +1,7 @@
 #include "pause_menu.hpp"
 #include "../main_menu/main_menu.hpp"
 #include "../../definitions.hpp"
+#include <chrono>
 #include <sstream>
 
 pause_menu::pause_menu(std::shared_ptr<game_data> data)
@@ -10,16 +11,30 @@ pause_menu::pause_menu(std::shared_ptr<game_data> data)
 	, _background()
 	, _resume_button()
 	, _home_button()
+	, _hits()
 	, _textures()
+	, _manifest()
+	, _loaded()
 {
+	_manifest.add_texture("Pause Menu Title", PAUSE_MENU_TITLE_FILEPATH);
+	_manifest.add_texture("Pause Menu Background", PAUSE_MENU_BACKGROUND_FILEPATH);
+	_manifest.add_texture("Pause Menu Resume Button", PAUSE_MENU_RESUME_BUTTON_FILEPATH);
+	_manifest.add_texture("Pause Menu Home Button", PAUSE_MENU_HOME_BUTTON_FILEPATH);
+}
+
+auto pause_menu::preload() -> void
+{
+	_loaded = _data->resource_manager.preload(_manifest); // runs while the previous state is still shown
+}
+
+auto pause_menu::ready() -> bool
+{
+	return (!_loaded.valid() || (_loaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready));
 }
 
 auto pause_menu::init() -> void
 {
-	_data->resource_manager.load_texture("Pause Menu Title", PAUSE_MENU_TITLE_FILEPATH);
-	_data->resource_manager.load_texture("Pause Menu Background", PAUSE_MENU_BACKGROUND_FILEPATH);
-	_data->resource_manager.load_texture("Pause Menu Resume Button", PAUSE_MENU_RESUME_BUTTON_FILEPATH);
-	_data->resource_manager.load_texture("Pause Menu Home Button", PAUSE_MENU_HOME_BUTTON_FILEPATH);
+	_data->resource_manager.load(_manifest); // only loads what preload() did not finish
 	
 	_textures.push_back(_data->resource_manager.get_texture_p("Pause Menu Title"));
 	_textures.push_back(_data->resource_manager.get_texture_p("Pause Menu Background"));
@@ -33,8 +48,25 @@ auto pause_menu::init() -> void
 	
 	_title.setPosition(0.0, 0.0);
 	_background.setPosition(0.0, 0.0);
+	_background.setColor(sf::Color(255, 255, 255, PAUSE_MENU_BACKGROUND_ALPHA)); // the paused game loop shows through
 	_resume_button.setPosition(((_data->window.getSize().x / 2.0) - (_resume_button.getGlobalBounds().width / 2.0)), ((_data->window.getSize().y / 2.0) - (_resume_button.getGlobalBounds().height / 2.0)));
 	_home_button.setPosition(((_data->window.getSize().x / 2.0) - (_home_button.getGlobalBounds().width / 2.0)), ((_data->window.getSize().y / 2.0 + _resume_button.getGlobalBounds().height + 2.0) - (_home_button.getGlobalBounds().height / 2.0)));
+	
+	_hits.add(_resume_button, 0, [this](sf::Mouse::Button button, sf::Vector2i const&)
+	{
+		if(button == sf::Mouse::Left)
+		{
+			_data->state_manager.remove();
+		}
+	});
+	_hits.add(_home_button, 0, [this](sf::Mouse::Button button, sf::Vector2i const&)
+	{
+		if(button == sf::Mouse::Left)
+		{
+			_data->state_manager.reset(std::unique_ptr<nstate>(new main_menu(_data))); // the game loop below is removed without being resumed
+			_data->particle_system.clr();
+		}
+	});
 }
 
 auto pause_menu::pause() -> void
@@ -50,21 +82,14 @@ auto pause_menu::handle() -> void
 	sf::Event event;
 	while(_data->window.pollEvent(event))
 	{
+		_data->input_manager.feed(event);
 		if(event.type == sf::Event::Closed)
 		{
 			_data->window.close();
 		}
-		if(_data->input_manager.clicked(_resume_button, sf::Mouse::Left, _data->window))
-		{
-			_data->state_manager.remove();
-		}
-		if(_data->input_manager.clicked(_home_button, sf::Mouse::Left, _data->window))
-		{
-			_data->state_manager.remove();
-			_data->state_manager.add(std::unique_ptr<nstate>(new main_menu(_data)), true);
-			_data->particle_system.clr();
-		}
 	}
+	_data->input_manager.next_frame(); // every query below reads this frame
+	_hits.dispatch(_data->input_manager.get_frame()); // one grid lookup per click instead of testing every button
 }
 
 auto pause_menu::update(float dt) -> void
@@ -75,6 +100,7 @@ auto pause_menu::draw(float dt) -> void
 {
 	_data->window.setActive(true);
 	_data->window.clear(sf::Color::Black);
+	_data->state_manager.draw_frame(_data->window); // the last frame of the paused game loop as one quad
 	_data->window.draw(_background);
 	_data->window.draw(_title);
 	_data->window.draw(_resume_button);
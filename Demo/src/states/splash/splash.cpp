@@ -5,6 +5,7 @@
 splash::splash(std::shared_ptr<game_data> data)
 	: _data(data)
 	, _clock()
+	, _leaving(false)
 	, _background()
 	, _textures()
 {
@@ -34,17 +35,20 @@ auto splash::handle() -> void
 	sf::Event event;
 	while(_data->window.pollEvent(event))
 	{
+		_data->input_manager.feed(event);
 		if(event.type == sf::Event::Closed)
 		{
 			_data->window.close();
 		}
 	}
+	_data->input_manager.next_frame(); // every query below reads this frame
 }
 
 auto splash::update(float dt) -> void
 {
-	if(_clock.getElapsedTime().asSeconds() > SPLASH_STATE_SHOW_TIME)
+	if((!_leaving) && (_clock.getElapsedTime().asSeconds() > SPLASH_STATE_SHOW_TIME)) // the splash keeps running until the main menu is ready
 	{
+		_leaving = true;
 		_data->state_manager.add(std::unique_ptr<nstate>(new main_menu(_data)), true);
 	}
 }
@@ -21,6 +21,7 @@ class splash : public nengine::nstate_manager::nstate
 	private:
 		std::shared_ptr<game_data> _data;
 		sf::Clock _clock;
+		bool _leaving;
 		sf::Sprite _background;
 		std::vector<std::shared_ptr<const sf::Texture>> _textures;
 };
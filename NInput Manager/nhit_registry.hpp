@@ -0,0 +1,469 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NINPUT_MANAGER__NHIT_REGISTRY__
+#define __NENGINE__NINPUT_MANAGER__NHIT_REGISTRY__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! SFML/Graphics.hpp for SFML structures
+// ! mutex for thread safety
+// ! unordered_map for the cells of the grid
+// ! vector for the regions, the regions of a cell and the oversized regions
+// ! functional for the handlers
+// ! cmath for the cells a region covers
+// ! ninput_manager for the ninput_frame to dispatch
+/////////////////////////////////////////////////////////////////////////////////
+#include <SFML/Graphics.hpp>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <functional>
+#include <cmath>
+#include "ninput_manager.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the edge length of a grid cell in pixels, a region is stored in every cell
+//   it covers, a hit only tests the regions of a single cell
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NHIT_CELL_SIZE
+#define NHIT_CELL_SIZE 64.0f
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the most cells a region is stored in, a larger region, e.g. a background,
+//   is kept in a single list every hit test checks instead
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NHIT_MAX_CELLS
+#define NHIT_MAX_CELLS 64
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the largest cell coordinate, positions beyond it are clamped to it
+/////////////////////////////////////////////////////////////////////////////////
+#define NHIT_CELL_LIMIT 1073741824
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the id returned if no region was hit
+/////////////////////////////////////////////////////////////////////////////////
+#define NHIT_NONE static_cast<std::size_t>(-1)
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the ninput_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace ninput_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the handler of a region, called with the pressed button and the position
+//   it went down at
+/////////////////////////////////////////////////////////////////////////////////
+typedef std::function<void(sf::Mouse::Button, sf::Vector2i const&)> nhit_handler;
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a single clickable region
+// ! _bounds: the area in window coordinates
+// ! _z: the z-order, the highest one is hit first
+// ! _order: the registration order, the newest one is hit first on the same _z
+// ! _active: false if the id is free
+/////////////////////////////////////////////////////////////////////////////////
+struct nhit_region
+{
+	sf::FloatRect _bounds;
+	int _z;
+	unsigned long long _order;
+	bool _active;
+	nhit_handler _handler;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the nhit_registry
+// ! keeps clickable regions in a uniform grid, so a hit test only looks at the
+//   few regions of one cell and the few oversized regions instead of every
+//   region
+/////////////////////////////////////////////////////////////////////////////////
+class nhit_registry
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nhit_registry(const nhit_registry&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nhit_registry& operator=(const nhit_registry&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		nhit_registry()
+			: _mutex()
+			, _regions()
+			, _free()
+			, _cells()
+			, _oversized()
+			, _order(0)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to add a clickable region
+		// @param1: the area in window coordinates
+		// @param2: the z-order, the highest one is hit first
+		// @param3: the handler called by dispatch()
+		// @return: the id of the region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add(sf::FloatRect const& bounds, int z, nhit_handler handler) -> std::size_t
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				std::size_t id = _regions.size();
+				if(!_free.empty())
+				{
+					id = _free.back();
+					_free.pop_back();
+				}
+				else
+				{
+					_regions.push_back(nhit_region());
+				}
+				nhit_region& region = _regions[id];
+				region._bounds = bounds;
+				region._z = z;
+				region._order = _order++;
+				region._active = true;
+				region._handler = std::move(handler);
+				_insert(id);
+				return id;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to add a sprite as clickable region, e.g. a sprite of a nlayer
+		// ! the bounds are taken once, call move() if the sprite moves
+		// @param1: the sf::Sprite
+		// @param2: the z-order, the highest one is hit first
+		// @param3: the handler called by dispatch()
+		// @return: the id of the region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add(sf::Sprite const& object, int z, nhit_handler handler) -> std::size_t
+		{
+			return add(object.getGlobalBounds(), z, std::move(handler));
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to move a region
+		// @param1: the id of the region
+		// @param2: the new area in window coordinates
+		/////////////////////////////////////////////////////////////////////////////////
+		auto move(std::size_t id, sf::FloatRect const& bounds) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if(_is_active(id))
+				{
+					_erase(id);
+					_regions[id]._bounds = bounds;
+					_insert(id);
+				}
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to remove a region, its id may be returned by a later add()
+		// @param1: the id of the region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto remove(std::size_t id) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if(_is_active(id))
+				{
+					_erase(id);
+					_regions[id]._active = false;
+					_regions[id]._handler = nullptr;
+					_free.push_back(id);
+				}
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to remove every region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto clr() -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_regions.clear();
+				_free.clear();
+				_cells.clear();
+				_oversized.clear();
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find the top-most region at a position
+		// @param1: the position in window coordinates
+		// @return: the id of the region or NHIT_NONE
+		/////////////////////////////////////////////////////////////////////////////////
+		auto hit(sf::Vector2i const& position) -> std::size_t
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				return _hit(position);
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! calls the handler of the top-most region under every button press of
+		//   the frame, at the position it went down, in the order they went down
+		// ! the handlers are called unlocked, so they may add or remove regions
+		// @param1: the published ninput_frame, see ninput_manager::get_frame()
+		// @return: the number of called handlers
+		/////////////////////////////////////////////////////////////////////////////////
+		auto dispatch(ninput_frame const& frame) -> unsigned int
+		{
+			unsigned int called = 0;
+			for(std::size_t i = 0; i < frame._press_count; i++)
+			{
+				npress const& press = frame._presses[i];
+				nhit_handler handler;
+				std::unique_lock<std::mutex> lock(_mutex);
+				{ // locked area
+					std::size_t id = _hit(press._position);
+					if(id != NHIT_NONE)
+					{
+						handler = _regions[id]._handler;
+					}
+				} // lock freed
+				lock.unlock();
+				if(handler)
+				{
+					handler(press._button, press._position);
+					called++;
+				}
+			}
+			return called;
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the regions, indexed by their id
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<nhit_region> _regions;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the ids of removed regions to reuse
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::size_t> _free;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the grid, only cells with regions exist, each sorted top-most first
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unordered_map<unsigned long long, std::vector<std::size_t>> _cells;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the regions covering more than NHIT_MAX_CELLS cells, sorted top-most first
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::size_t> _oversized;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the registration order of the next region
+		/////////////////////////////////////////////////////////////////////////////////
+		unsigned long long _order;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the cell coordinate of a position
+		// @param1: a x or y position in window coordinates
+		// @return: the cell coordinate, clamped to NHIT_CELL_LIMIT
+		/////////////////////////////////////////////////////////////////////////////////
+		static auto _get_cell(float position) -> int
+		{
+			float cell = std::floor(position / NHIT_CELL_SIZE);
+			if(!(cell > -NHIT_CELL_LIMIT))
+			{
+				return -NHIT_CELL_LIMIT;
+			}
+			if(cell > NHIT_CELL_LIMIT)
+			{
+				return NHIT_CELL_LIMIT;
+			}
+			return static_cast<int>(cell);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the key of a cell in the grid
+		// @param1: the cell x coordinate
+		// @param2: the cell y coordinate
+		// @return: the key of the cell
+		/////////////////////////////////////////////////////////////////////////////////
+		static auto _get_key(int x, int y) -> unsigned long long
+		{
+			return ((static_cast<unsigned long long>(static_cast<unsigned int>(x)) << 32) | static_cast<unsigned int>(y));
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a region covers too many cells to be stored in each of them
+		// @param1: the area of the region
+		// @return: indicator if the region belongs to _oversized
+		/////////////////////////////////////////////////////////////////////////////////
+		static auto _is_oversized(sf::FloatRect const& bounds) -> bool
+		{
+			long long columns = (static_cast<long long>(_get_cell(bounds.left + bounds.width)) - _get_cell(bounds.left) + 1);
+			long long rows = (static_cast<long long>(_get_cell(bounds.top + bounds.height)) - _get_cell(bounds.top) + 1);
+			return ((columns * rows) > NHIT_MAX_CELLS);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if an id belongs to a region, must be locked
+		// @param1: the id
+		// @return: indicator if the region exists
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _is_active(std::size_t id) const -> bool
+		{
+			return (id < _regions.size()) && _regions[id]._active;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a region is above another one, must be locked
+		// @param1: the id of the first region
+		// @param2: the id of the second region
+		// @return: indicator if the first region is hit before the second one
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _is_above(std::size_t first, std::size_t second) const -> bool
+		{
+			if(_regions[first]._z != _regions[second]._z)
+			{
+				return _regions[first]._z > _regions[second]._z;
+			}
+			return _regions[first]._order > _regions[second]._order;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! stores a region in every cell it covers or in _oversized, keeping them
+		//   sorted, must be locked
+		// @param1: the id of the region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _insert(std::size_t id) -> void
+		{
+			sf::FloatRect const& bounds = _regions[id]._bounds;
+			if(_is_oversized(bounds))
+			{
+				_insert_sorted(_oversized, id);
+				return;
+			}
+			for(int x = _get_cell(bounds.left); x <= _get_cell(bounds.left + bounds.width); x++)
+			{
+				for(int y = _get_cell(bounds.top); y <= _get_cell(bounds.top + bounds.height); y++)
+				{
+					_insert_sorted(_cells[_get_key(x, y)], id);
+				}
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! inserts a region into a list behind every region above it, must be locked
+		// @param1: the list, top-most first
+		// @param2: the id of the region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _insert_sorted(std::vector<std::size_t>& list, std::size_t id) -> void
+		{
+			auto it = list.begin();
+			while((it != list.end()) && _is_above(*it, id))
+				++it;
+			list.insert(it, id);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! removes a region from every cell it covers or from _oversized, must be
+		//   locked
+		// @param1: the id of the region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _erase(std::size_t id) -> void
+		{
+			sf::FloatRect const& bounds = _regions[id]._bounds;
+			if(_is_oversized(bounds))
+			{
+				_erase_from(_oversized, id);
+				return;
+			}
+			for(int x = _get_cell(bounds.left); x <= _get_cell(bounds.left + bounds.width); x++)
+			{
+				for(int y = _get_cell(bounds.top); y <= _get_cell(bounds.top + bounds.height); y++)
+				{
+					auto found = _cells.find(_get_key(x, y));
+					if(found == _cells.end())
+						continue;
+					_erase_from(found->second, id);
+					if(found->second.empty())
+					{
+						_cells.erase(found);
+					}
+				}
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! removes a region from a list, must be locked
+		// @param1: the list
+		// @param2: the id of the region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _erase_from(std::vector<std::size_t>& list, std::size_t id) -> void
+		{
+			for(auto it = list.begin(); it != list.end(); ++it)
+			{
+				if(*it == id)
+				{
+					list.erase(it);
+					break;
+				}
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find the top-most region at a position, must be locked
+		// @param1: the position in window coordinates
+		// @return: the id of the region or NHIT_NONE
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _hit(sf::Vector2i const& position) const -> std::size_t
+		{
+			std::size_t hit = NHIT_NONE;
+			auto found = _cells.find(_get_key(_get_cell(position.x), _get_cell(position.y)));
+			if(found != _cells.end())
+			{
+				for(std::size_t id : found->second)
+				{
+					if(_regions[id]._bounds.contains(static_cast<float>(position.x), static_cast<float>(position.y)))
+					{
+						hit = id;
+						break;
+					}
+				}
+			}
+			for(std::size_t id : _oversized)
+			{
+				if(_regions[id]._bounds.contains(static_cast<float>(position.x), static_cast<float>(position.y)))
+				{
+					if((hit == NHIT_NONE) || _is_above(id, hit))
+					{
+						hit = id;
+					}
+					break;
+				}
+			}
+			return hit;
+		}
+}; // end of class nhit_registry
+
+} // end of namespace ninput_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NINPUT_MANAGER__NHIT_REGISTRY__
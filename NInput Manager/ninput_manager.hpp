@@ -29,12 +29,46 @@
 // ! SFML/Graphics.hpp for SFML structures
 // ! mutex for thread safety
 // ! unordered_map for custom key bindings
-// ! memory for shared pointer
+// ! vector for the bindings of the actions
+// ! array for the published input frames
+// ! atomic for publishing the input frames lock-free
+// ! bitset for the pressed, released and held keys and buttons
 /////////////////////////////////////////////////////////////////////////////////
 #include <SFML/Graphics.hpp>
 #include <mutex>
 #include <unordered_map>
-#include <memory>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <bitset>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the number of published input frames, a query racing with more than
+//   NINPUT_FRAMES - 1 calls of next_frame() may read a frame that is rewritten
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NINPUT_FRAMES
+#define NINPUT_FRAMES 3
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the maximum number of actions, the size of the action bitsets
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NINPUT_ACTIONS
+#define NINPUT_ACTIONS 256
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the maximum number of button presses kept per input frame, later presses
+//   of the same frame are only counted in the bitsets
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NINPUT_PRESSES
+#define NINPUT_PRESSES 16
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the id returned if an action is unknown or NINPUT_ACTIONS are used
+/////////////////////////////////////////////////////////////////////////////////
+#define NINPUT_NO_ACTION static_cast<nengine::ninput_manager::naction>(-1)
 
 /////////////////////////////////////////////////////////////////////////////////
 // ! namespace for the nengine
@@ -61,6 +95,11 @@ enum class ninput_type
 	MOUSE
 };
 
+/////////////////////////////////////////////////////////////////////////////////
+// ! the id of an action, see ninput_manager::get_action()
+/////////////////////////////////////////////////////////////////////////////////
+typedef unsigned int naction;
+
 /////////////////////////////////////////////////////////////////////////////////
 // ! the nkey
 /////////////////////////////////////////////////////////////////////////////////
@@ -73,6 +112,52 @@ struct nkey
 	auto change_bind_mouse(sf::Mouse::Button const& input) -> void {_button = input;};
 };
 
+/////////////////////////////////////////////////////////////////////////////////
+// ! a single binding of a key or button to an action
+/////////////////////////////////////////////////////////////////////////////////
+struct nbinding
+{
+	naction _action;
+	nkey _input;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a single mouse button press and the cursor position it went down at
+/////////////////////////////////////////////////////////////////////////////////
+struct npress
+{
+	sf::Mouse::Button _button;
+	sf::Vector2i _position;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the input of a single frame, built from the events of the window
+// ! _pressed_*: went down during the frame
+// ! _released_*: went up during the frame
+// ! _held_*: are down at the end of the frame
+// ! _press_positions: the cursor position of the last press of every button
+// ! _presses: every button press in the order they went down, the first
+//   _press_count are used
+// ! _mouse_position: the cursor position at the end of the frame
+// ! _*_actions: the same for the actions, computed once from their bindings
+/////////////////////////////////////////////////////////////////////////////////
+struct ninput_frame
+{
+	std::bitset<sf::Keyboard::KeyCount> _pressed_keys;
+	std::bitset<sf::Keyboard::KeyCount> _released_keys;
+	std::bitset<sf::Keyboard::KeyCount> _held_keys;
+	std::bitset<sf::Mouse::ButtonCount> _pressed_buttons;
+	std::bitset<sf::Mouse::ButtonCount> _released_buttons;
+	std::bitset<sf::Mouse::ButtonCount> _held_buttons;
+	std::array<sf::Vector2i, sf::Mouse::ButtonCount> _press_positions;
+	std::array<npress, NINPUT_PRESSES> _presses;
+	std::size_t _press_count;
+	sf::Vector2i _mouse_position;
+	std::bitset<NINPUT_ACTIONS> _pressed_actions;
+	std::bitset<NINPUT_ACTIONS> _released_actions;
+	std::bitset<NINPUT_ACTIONS> _held_actions;
+};
+
 /////////////////////////////////////////////////////////////////////////////////
 // ! the ninput_manager
 /////////////////////////////////////////////////////////////////////////////////
@@ -92,139 +177,548 @@ class ninput_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		ninput_manager()
 			: _mutex()
+			, _actions()
+			, _bindings()
+			, _building()
+			, _frames()
+			, _current(0)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a single event to the input frame that is built
+		// ! called for every event of sf::Window::pollEvent(), always by the same
+		//   thread, events that are no input are ignored
+		// @param1: the polled sf::Event
+		/////////////////////////////////////////////////////////////////////////////////
+		auto feed(sf::Event const& event) -> void
+		{
+			switch(event.type)
+			{
+				case sf::Event::KeyPressed:
+					if(_is_key(event.key.code))
+					{
+						if(!_building._held_keys.test(event.key.code)) // no key repeat
+						{
+							_building._pressed_keys.set(event.key.code);
+							_press_actions(ninput_type::KEYBOARD, event.key.code);
+						}
+						_building._held_keys.set(event.key.code);
+					}
+					break;
+				case sf::Event::KeyReleased:
+					if(_is_key(event.key.code))
+					{
+						_building._released_keys.set(event.key.code);
+						_building._held_keys.reset(event.key.code);
+					}
+					break;
+				case sf::Event::MouseButtonPressed:
+					if(_is_button(event.mouseButton.button))
+					{
+						if(!_building._held_buttons.test(event.mouseButton.button))
+						{
+							_press_actions(ninput_type::MOUSE, event.mouseButton.button);
+						}
+						_building._pressed_buttons.set(event.mouseButton.button);
+						_building._held_buttons.set(event.mouseButton.button);
+						_building._press_positions[event.mouseButton.button] = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+						if(_building._press_count < NINPUT_PRESSES)
+						{
+							_building._presses[_building._press_count]._button = static_cast<sf::Mouse::Button>(event.mouseButton.button);
+							_building._presses[_building._press_count]._position = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+							_building._press_count++;
+						}
+					}
+					_building._mouse_position = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+					break;
+				case sf::Event::MouseButtonReleased:
+					if(_is_button(event.mouseButton.button))
+					{
+						_building._released_buttons.set(event.mouseButton.button);
+						_building._held_buttons.reset(event.mouseButton.button);
+					}
+					_building._mouse_position = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+					break;
+				case sf::Event::MouseMoved:
+					_building._mouse_position = sf::Vector2i(event.mouseMove.x, event.mouseMove.y);
+					break;
+				case sf::Event::LostFocus: // the releases go to another window
+					_building._released_keys |= _building._held_keys;
+					_building._released_buttons |= _building._held_buttons;
+					_building._held_keys.reset();
+					_building._held_buttons.reset();
+					break;
+				default:
+					break;
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! publishes the built input frame to every query and starts the next one
+		// ! called once per frame after the events were fed, by the feeding thread
+		/////////////////////////////////////////////////////////////////////////////////
+		auto next_frame() -> void
+		{
+			std::size_t current = _current.load(std::memory_order_relaxed);
+			std::size_t next = (current + 1) % NINPUT_FRAMES;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_update_actions();
+			} // lock freed
+			lock.unlock();
+			_frames[next] = _building;
+			_current.store(next, std::memory_order_release);
+			_building._pressed_keys.reset();
+			_building._released_keys.reset();
+			_building._pressed_buttons.reset();
+			_building._released_buttons.reset();
+			_building._press_count = 0;
+			_building._pressed_actions.reset();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the published input frame
+		// @return: the last input frame published by next_frame()
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_frame() const -> ninput_frame const&
+		{
+			return _frames[_current.load(std::memory_order_acquire)];
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a key went down during the published frame
+		// @param1: the sf::Keyboard key
+		// @return: indicator if the key was pressed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto is_pressed(sf::Keyboard::Key const& key) const -> bool
+		{
+			return _is_key(key) && get_frame()._pressed_keys.test(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a key went up during the published frame
+		// @param1: the sf::Keyboard key
+		// @return: indicator if the key was released
+		/////////////////////////////////////////////////////////////////////////////////
+		auto is_released(sf::Keyboard::Key const& key) const -> bool
+		{
+			return _is_key(key) && get_frame()._released_keys.test(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a key is down at the end of the published frame
+		// @param1: the sf::Keyboard key
+		// @return: indicator if the key is held
+		/////////////////////////////////////////////////////////////////////////////////
+		auto is_held(sf::Keyboard::Key const& key) const -> bool
+		{
+			return _is_key(key) && get_frame()._held_keys.test(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a button went down during the published frame
+		// @param1: the sf::Mouse button
+		// @return: indicator if the button was pressed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto is_pressed(sf::Mouse::Button const& button) const -> bool
+		{
+			return _is_button(button) && get_frame()._pressed_buttons.test(button);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a button went up during the published frame
+		// @param1: the sf::Mouse button
+		// @return: indicator if the button was released
+		/////////////////////////////////////////////////////////////////////////////////
+		auto is_released(sf::Mouse::Button const& button) const -> bool
+		{
+			return _is_button(button) && get_frame()._released_buttons.test(button);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a button is down at the end of the published frame
+		// @param1: the sf::Mouse button
+		// @return: indicator if the button is held
+		/////////////////////////////////////////////////////////////////////////////////
+		auto is_held(sf::Mouse::Button const& button) const -> bool
 		{
+			return _is_button(button) && get_frame()._held_buttons.test(button);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! to check if a sprite was clicked
+		// ! reads the published frame, a click that went down and up between two
+		//   frames counts at the position it went down
 		// @param1: the sf::Sprite that needs to be checked
 		// @param2: the sf::Mouse button event
-		// @param3: the sf::RenderWindow where this click presumably takes place
+		// @param3: the sf::RenderWindow where this click presumably takes place, the
+		//          fed events are already relative to it
 		// @return: indicator if the sprite was clicked
 		/////////////////////////////////////////////////////////////////////////////////
-		auto clicked(sf::Sprite const& object, sf::Mouse::Button const& button, sf::RenderWindow const& window) -> bool
+		auto clicked(sf::Sprite const& object, sf::Mouse::Button const& button, sf::RenderWindow const&) const -> bool
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
-			{ // locked area
-				if(sf::Mouse::isButtonPressed(button))
-				{
-					sf::IntRect tmp_rect(object.getPosition().x, object.getPosition().y, object.getGlobalBounds().width, object.getGlobalBounds().height);
-					if(tmp_rect.contains(sf::Mouse::getPosition(window)))
-					{
-						return true;
-					}
-				}
+			if(!_is_button(button))
+			{
 				return false;
-			} // lock freed
+			}
+			ninput_frame const& frame = get_frame();
+			sf::Vector2i position;
+			if(frame._pressed_buttons.test(button))
+			{
+				position = frame._press_positions[button];
+			}
+			else if(frame._held_buttons.test(button))
+			{
+				position = frame._mouse_position;
+			}
+			else
+			{
+				return false;
+			}
+			sf::IntRect tmp_rect(object.getPosition().x, object.getPosition().y, object.getGlobalBounds().width, object.getGlobalBounds().height);
+			return tmp_rect.contains(position);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! get sf::Mouse position relative to the sf::RenderWindow
-		// @param1: the sf::RenderWindow to get the relative sf::Mouse position from
+		// @param1: the sf::RenderWindow to get the relative sf::Mouse position from,
+		//          the fed events are already relative to it
 		// @return: a sf::Vector2i that indicates the sf::Mouse position relative
-		//          to the sf::RenderWindow
+		//          to the sf::RenderWindow at the end of the published frame
 		/////////////////////////////////////////////////////////////////////////////////
-		auto get_mouse_position(sf::RenderWindow const& window) -> sf::Vector2i
+		auto get_mouse_position(sf::RenderWindow const&) const -> sf::Vector2i
+		{
+			return get_frame()._mouse_position;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to get the id of an action, the action is added if it is new
+		// ! the id stays the same for the same name, so it is looked up once and
+		//   kept, every query by id is a single bit test
+		// @param1: the name of the action
+		// @return: the id of the action, NINPUT_NO_ACTION if NINPUT_ACTIONS are used
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_action(std::string const& name) -> naction
 		{
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				return sf::Mouse::getPosition(window);
+				return _get_action(name, true);
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! used to add a key binding
+		// ! used to bind a key to an action, an action may have many bindings
+		// @param1: the id of the action
+		// @param2: the sf::Keyboard key
 		/////////////////////////////////////////////////////////////////////////////////
-		auto add_bind(std::string const& key, sf::Keyboard::Key const& input) -> void
+		auto bind(naction action, sf::Keyboard::Key const& input) -> void
 		{
+			nkey binding;
+			binding._type = ninput_type::KEYBOARD;
+			binding._key = input;
+			binding._button = sf::Mouse::ButtonCount;
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				if(_key_bindings.find(key) == _key_bindings.end()) // not yet inserted
-				{
-					auto tmp = std::make_shared<nkey>();
-					tmp->_type = ninput_type::KEYBOARD;
-					tmp->_key = input;
-					_key_bindings.insert(std::make_pair(key, tmp));
-				}
+				_bind(action, binding);
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! used to add a button binding
+		// ! used to bind a button to an action, an action may have many bindings
+		// @param1: the id of the action
+		// @param2: the sf::Mouse button
 		/////////////////////////////////////////////////////////////////////////////////
-		auto add_bind(std::string const& key, sf::Mouse::Button const& input) -> void
+		auto bind(naction action, sf::Mouse::Button const& input) -> void
 		{
+			nkey binding;
+			binding._type = ninput_type::MOUSE;
+			binding._key = sf::Keyboard::Unknown;
+			binding._button = input;
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				if(_key_bindings.find(key) == _key_bindings.end()) // not yet inserted
-				{
-					auto tmp = std::make_shared<nkey>();
-					tmp->_type = ninput_type::MOUSE;
-					tmp->_button = input;
-					_key_bindings.insert(std::make_pair(key, tmp));
-				}
+				_bind(action, binding);
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to remove every binding of an action, the id stays valid
+		// @param1: the id of the action
+		/////////////////////////////////////////////////////////////////////////////////
+		auto unbind(naction action) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_unbind(action, ninput_type::KEYBOARD);
+				_unbind(action, ninput_type::MOUSE);
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if an action went down during the published frame
+		// ! a second binding going down while the action is held is no press
+		// @param1: the id of the action
+		// @return: indicator if the action was pressed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto action_pressed(naction action) const -> bool
+		{
+			return (action < NINPUT_ACTIONS) && get_frame()._pressed_actions.test(action);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if an action went up during the published frame
+		// ! true once the last held binding went up
+		// @param1: the id of the action
+		// @return: indicator if the action was released
+		/////////////////////////////////////////////////////////////////////////////////
+		auto action_released(naction action) const -> bool
+		{
+			return (action < NINPUT_ACTIONS) && get_frame()._released_actions.test(action);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if any binding of an action is down at the end of the published
+		//   frame
+		// @param1: the id of the action
+		// @return: indicator if the action is held
+		/////////////////////////////////////////////////////////////////////////////////
+		auto action_held(naction action) const -> bool
+		{
+			return (action < NINPUT_ACTIONS) && get_frame()._held_actions.test(action);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to add a key binding
+		// ! the name is an action, a further binding is added to it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_bind(std::string const& key, sf::Keyboard::Key const& input) -> void
+		{
+			bind(get_action(key), input);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to add a button binding
+		// ! the name is an action, a further binding is added to it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_bind(std::string const& key, sf::Mouse::Button const& input) -> void
+		{
+			bind(get_action(key), input);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
 		// ! used to change a key binding
+		// ! replaces every key binding of the action
 		// ! does NOT add if not found
 		/////////////////////////////////////////////////////////////////////////////////
 		auto change_bind(std::string const& key, sf::Keyboard::Key const& input) -> void
 		{
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				if(_key_bindings.find(key) != _key_bindings.end()) // already inserted
+				naction action = _get_action(key, false);
+				if(_unbind(action, ninput_type::KEYBOARD))
 				{
-					if(_key_bindings.at(key)->_type == ninput_type::KEYBOARD)
-					{
-						_key_bindings.at(key)->change_bind_keyboard(input);
-					}
+					nkey binding;
+					binding._type = ninput_type::KEYBOARD;
+					binding._key = input;
+					binding._button = sf::Mouse::ButtonCount;
+					_bind(action, binding);
 				}
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! used to change a button binding
+		// ! replaces every button binding of the action
 		// ! does NOT add if not found
 		/////////////////////////////////////////////////////////////////////////////////
 		auto change_bind(std::string const& key, sf::Mouse::Button const& input) -> void
 		{
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				if(_key_bindings.find(key) != _key_bindings.end()) // already inserted
+				naction action = _get_action(key, false);
+				if(_unbind(action, ninput_type::MOUSE))
 				{
-					if(_key_bindings.at(key)->_type == ninput_type::MOUSE)
-					{
-						_key_bindings.at(key)->change_bind_mouse(input);
-					}
+					nkey binding;
+					binding._type = ninput_type::MOUSE;
+					binding._key = sf::Keyboard::Unknown;
+					binding._button = input;
+					_bind(action, binding);
 				}
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! used to check a key or button binding
+		// ! true if it was pressed during or is held at the end of the published frame
+		// ! looks the name up every call, keep the id of get_action() instead
 		/////////////////////////////////////////////////////////////////////////////////
 		auto check_bind(std::string const& key) -> bool
 		{
+			naction action = NINPUT_NO_ACTION;
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				if(_key_bindings.find(key) != _key_bindings.end()) // already inserted
+				action = _get_action(key, false);
+			} // lock freed
+			lock.unlock();
+			return action_pressed(action) || action_held(action);
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to store the ids of the actions by name
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unordered_map<std::string, naction> _actions;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! used to store custom key configuration, every binding of every action
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<nbinding> _bindings;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the input frame the fed events are added to
+		/////////////////////////////////////////////////////////////////////////////////
+		ninput_frame _building;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the published input frames, the current one is read by every query
+		/////////////////////////////////////////////////////////////////////////////////
+		std::array<ninput_frame, NINPUT_FRAMES> _frames;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the index of the current published input frame
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<std::size_t> _current;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a key code can be stored in a bitset
+		// @param1: the key code of a sf::Event or a sf::Keyboard key
+		// @return: indicator if it is a known key
+		/////////////////////////////////////////////////////////////////////////////////
+		static auto _is_key(int key) -> bool
+		{
+			return (key >= 0) && (key < sf::Keyboard::KeyCount);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if a button code can be stored in a bitset
+		// @param1: the button code of a sf::Event or a sf::Mouse button
+		// @return: indicator if it is a known button
+		/////////////////////////////////////////////////////////////////////////////////
+		static auto _is_button(int button) -> bool
+		{
+			return (button >= 0) && (button < sf::Mouse::ButtonCount);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the id of an action, must be locked
+		// @param1: the name of the action
+		// @param2: if a new action is added
+		// @return: the id of the action or NINPUT_NO_ACTION
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_action(std::string const& name, bool adding) -> naction
+		{
+			auto found = _actions.find(name);
+			if(found != _actions.end())
+			{
+				return found->second;
+			}
+			if((!adding) || (_actions.size() >= NINPUT_ACTIONS))
+			{
+				return NINPUT_NO_ACTION;
+			}
+			naction action = static_cast<naction>(_actions.size());
+			_actions.insert(std::make_pair(name, action));
+			return action;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a binding to an action if it is not bound yet, must be locked
+		// @param1: the id of the action
+		// @param2: the key or button
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _bind(naction action, nkey const& input) -> void
+		{
+			if(action >= NINPUT_ACTIONS)
+			{
+				return;
+			}
+			for(auto const& binding : _bindings)
+			{
+				if((binding._action == action) && (binding._input._type == input._type) && (binding._input._key == input._key) && (binding._input._button == input._button))
+				{
+					return;
+				}
+			}
+			nbinding binding;
+			binding._action = action;
+			binding._input = input;
+			_bindings.push_back(binding);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! removes the bindings of an action of one input type, must be locked
+		// @param1: the id of the action
+		// @param2: the input type of the removed bindings
+		// @return: indicator if a binding was removed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _unbind(naction action, ninput_type type) -> bool
+		{
+			bool removed = false;
+			for(std::size_t i = 0; i < _bindings.size();)
+			{
+				if((_bindings[i]._action == action) && (_bindings[i]._input._type == type))
+				{
+					_bindings.erase(_bindings.begin() + i);
+					removed = true;
+				}
+				else
 				{
-					if((_key_bindings.at(key)->_type == ninput_type::KEYBOARD) && (sf::Keyboard::isKeyPressed(_key_bindings.at(key)->_key)))
+					i++;
+				}
+			}
+			return removed;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check if the key or button of a binding is down in the built frame
+		// @param1: the binding
+		// @return: indicator if the binding is held
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _is_held(nbinding const& binding) const -> bool
+		{
+			if((binding._input._type == ninput_type::KEYBOARD) && _is_key(binding._input._key))
+			{
+				return _building._held_keys.test(binding._input._key);
+			}
+			if((binding._input._type == ninput_type::MOUSE) && _is_button(binding._input._button))
+			{
+				return _building._held_buttons.test(binding._input._button);
+			}
+			return false;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the pressed bit of every action bound to a key or button that
+		//   went down, unless another binding of the action is already held
+		// ! called by feed() for every press event before the key or button is
+		//   set as held, so a press and release between two frames still counts
+		// @param1: the input type of the event
+		// @param2: the key or button code of the event
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _press_actions(ninput_type type, int code) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				for(auto const& binding : _bindings)
+				{
+					bool bound = (type == ninput_type::KEYBOARD) ? (binding._input._key == code) : (binding._input._button == code);
+					if((binding._input._type != type) || !bound)
+					{
+						continue;
+					}
+					bool held = false;
+					for(auto const& other : _bindings)
 					{
-						return true;
+						held = held || ((&other != &binding) && (other._action == binding._action) && _is_held(other));
 					}
-					if((_key_bindings.at(key)->_type == ninput_type::MOUSE) && (sf::Mouse::isButtonPressed(_key_bindings.at(key)->_button)))
+					if(!held) // another binding of a held action is no press
 					{
-						return true;
+						_building._pressed_actions.set(binding._action);
 					}
 				}
-				return false;
 			} // lock freed
 		}
-	private:
-		/////////////////////////////////////////////////////////////////////////////////
-		// ! for thread safety
-		/////////////////////////////////////////////////////////////////////////////////
-		std::mutex _mutex;
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! used to store custom key configuration
+		// ! computes the held and released action bitsets of the built frame from
+		//   its keys and buttons, the pressed ones are set by feed(), must be locked
 		/////////////////////////////////////////////////////////////////////////////////
-		std::unordered_map<std::string, std::shared_ptr<nkey>> _key_bindings;
+		auto _update_actions() -> void
+		{
+			std::bitset<NINPUT_ACTIONS> released;
+			_building._held_actions.reset();
+			for(auto const& binding : _bindings)
+			{
+				if((binding._input._type == ninput_type::KEYBOARD) && _is_key(binding._input._key))
+				{
+					released[binding._action] = released[binding._action] || _building._released_keys.test(binding._input._key);
+				}
+				if((binding._input._type == ninput_type::MOUSE) && _is_button(binding._input._button))
+				{
+					released[binding._action] = released[binding._action] || _building._released_buttons.test(binding._input._button);
+				}
+				_building._held_actions[binding._action] = _building._held_actions[binding._action] || _is_held(binding);
+			}
+			_building._released_actions = released & ~_building._held_actions; // only once the last binding went up
+		}
 }; // end of class ninput_manager
 
 } // end of namespace ninput_manager
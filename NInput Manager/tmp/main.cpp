@@ -1,24 +1,203 @@
 #include "../ninput_manager.hpp"
+#include "../nhit_registry.hpp"
 
+#include <chrono>
 #include <iostream>
 
-int main()
+/////////////////////////////////////////////////////////////////////////////////
+// ! headless test: feeds synthetic events, no window is opened
+/////////////////////////////////////////////////////////////////////////////////
+int failed = 0;
+
+void check(bool condition, char const* name)
+{
+	std::cout << (condition ? "ok      " : "FAILED  ") << name << std::endl;
+	if(!condition)
+		failed++;
+}
+
+sf::Event key_event(sf::Event::EventType type, sf::Keyboard::Key key)
+{
+	sf::Event event;
+	event.type = type;
+	event.key.code = key;
+	return event;
+}
+
+sf::Event button_event(sf::Event::EventType type, sf::Mouse::Button button, int x, int y)
+{
+	sf::Event event;
+	event.type = type;
+	event.mouseButton.button = button;
+	event.mouseButton.x = x;
+	event.mouseButton.y = y;
+	return event;
+}
+
+sf::Event move_event(int x, int y)
 {
-    sf::RenderWindow window(sf::VideoMode(960, 540), "Input Manager Test");
-	
-    while (window.isOpen())
-    {
-        sf::Event event;
-        while (window.pollEvent(event))
-        {
-            if (event.type == sf::Event::Closed)
-                window.close();
-        }
-        
-        window.clear(sf::Color::Black);
-        window.display();
-    }
-	
-	return 0;
+	sf::Event event;
+	event.type = sf::Event::MouseMoved;
+	event.mouseMove.x = x;
+	event.mouseMove.y = y;
+	return event;
 }
 
+int main()
+{
+	nengine::ninput_manager::ninput_manager input_manager;
+	sf::RenderWindow window; // never opened
+	sf::Sprite button; // no texture, so no OpenGL context is needed
+	button.setTextureRect(sf::IntRect(0, 0, 50, 20));
+	button.setPosition(100, 100);
+	
+	// frame 1: a key goes down and stays, a click goes down and up inside the button
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::A));
+	input_manager.feed(button_event(sf::Event::MouseButtonPressed, sf::Mouse::Left, 110, 105));
+	input_manager.feed(button_event(sf::Event::MouseButtonReleased, sf::Mouse::Left, 300, 300));
+	check(!input_manager.is_pressed(sf::Keyboard::A), "nothing is visible before next_frame()");
+	input_manager.next_frame();
+	check(input_manager.is_pressed(sf::Keyboard::A), "key pressed");
+	check(input_manager.is_held(sf::Keyboard::A), "key held");
+	check(!input_manager.is_released(sf::Keyboard::A), "key not released");
+	check(input_manager.is_pressed(sf::Mouse::Left) && input_manager.is_released(sf::Mouse::Left), "click between two frames");
+	check(!input_manager.is_held(sf::Mouse::Left), "button not held");
+	check(input_manager.clicked(button, sf::Mouse::Left, window), "click counts where it went down");
+	check(input_manager.get_mouse_position(window) == sf::Vector2i(300, 300), "cursor position");
+	
+	// frame 2: key repeat, the cursor moves onto the button without a click
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::A));
+	input_manager.feed(move_event(120, 110));
+	input_manager.next_frame();
+	check(!input_manager.is_pressed(sf::Keyboard::A), "key repeat is no press");
+	check(input_manager.is_held(sf::Keyboard::A), "key still held");
+	check(!input_manager.clicked(button, sf::Mouse::Left, window), "hovering is no click");
+	
+	// frame 3: the button is held on the sprite, the key goes up
+	input_manager.feed(button_event(sf::Event::MouseButtonPressed, sf::Mouse::Left, 120, 110));
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::A));
+	input_manager.next_frame();
+	check(input_manager.is_released(sf::Keyboard::A) && !input_manager.is_held(sf::Keyboard::A), "key released");
+	
+	// frame 4: nothing happens
+	input_manager.next_frame();
+	check(!input_manager.is_pressed(sf::Mouse::Left) && input_manager.is_held(sf::Mouse::Left), "button held without a new press");
+	check(input_manager.clicked(button, sf::Mouse::Left, window), "held button on the sprite");
+	
+	// frame 5: the window loses the focus while the button is held
+	sf::Event focus;
+	focus.type = sf::Event::LostFocus;
+	input_manager.feed(focus);
+	input_manager.next_frame();
+	check(input_manager.is_released(sf::Mouse::Left) && !input_manager.is_held(sf::Mouse::Left), "lost focus releases everything");
+	
+	// bindings read the same frame
+	input_manager.add_bind("Jump", sf::Keyboard::W);
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::W));
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::W));
+	input_manager.next_frame();
+	check(input_manager.check_bind("Jump"), "binding tapped between two frames");
+	
+	// actions with two bindings each
+	nengine::ninput_manager::naction left = input_manager.get_action("Left");
+	check(input_manager.get_action("Left") == left, "interned action id");
+	input_manager.bind(left, sf::Keyboard::A);
+	input_manager.bind(left, sf::Keyboard::Left);
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::A));
+	input_manager.next_frame();
+	check(input_manager.action_pressed(left) && input_manager.action_held(left), "action pressed");
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::Left));
+	input_manager.next_frame();
+	check(!input_manager.action_pressed(left) && input_manager.action_held(left), "second binding of a held action is no press");
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::A));
+	input_manager.next_frame();
+	check(!input_manager.action_released(left) && input_manager.action_held(left), "still held by the other binding");
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::Left));
+	input_manager.next_frame();
+	check(input_manager.action_released(left) && !input_manager.action_held(left), "released with the last binding");
+	input_manager.next_frame();
+	check(!input_manager.action_pressed(left) && !input_manager.action_released(left), "edges last a single frame");
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::A));
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::A));
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::Left));
+	input_manager.next_frame();
+	check(input_manager.action_pressed(left) && input_manager.action_held(left), "second binding pressed after the first went up is a press");
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::Left));
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::A));
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::A));
+	input_manager.next_frame();
+	check(input_manager.action_pressed(left) && input_manager.action_released(left) && !input_manager.action_held(left), "held action tapped again between two frames is a press");
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::A));
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::Left));
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::A));
+	input_manager.feed(key_event(sf::Event::KeyReleased, sf::Keyboard::Left));
+	input_manager.next_frame();
+	check(input_manager.action_pressed(left) && input_manager.action_released(left), "overlapping bindings between two frames are a press");
+	input_manager.change_bind("Left", sf::Keyboard::D);
+	input_manager.feed(key_event(sf::Event::KeyPressed, sf::Keyboard::A));
+	input_manager.next_frame();
+	check(!input_manager.action_pressed(left), "changed binding");
+	check(!input_manager.action_pressed(NINPUT_NO_ACTION), "unknown action");
+	
+	// the hit registry resolves the top-most region
+	nengine::ninput_manager::nhit_registry hits;
+	int clicked_id = -1;
+	std::size_t below = hits.add(sf::FloatRect(0, 0, 500, 500), 0, [&clicked_id](sf::Mouse::Button, sf::Vector2i const&) {clicked_id = 0;});
+	std::size_t above = hits.add(sf::FloatRect(100, 100, 50, 20), 1, [&clicked_id](sf::Mouse::Button, sf::Vector2i const&) {clicked_id = 1;});
+	std::size_t newer = hits.add(sf::FloatRect(90, 90, 10, 10), 0, [&clicked_id](sf::Mouse::Button, sf::Vector2i const&) {clicked_id = 2;});
+	check(hits.hit(sf::Vector2i(110, 105)) == above, "higher z wins");
+	check(hits.hit(sf::Vector2i(95, 95)) == newer, "newer region wins on the same z");
+	check(hits.hit(sf::Vector2i(400, 400)) == below, "region spanning many cells");
+	check(hits.hit(sf::Vector2i(600, 600)) == NHIT_NONE, "nothing hit");
+	hits.move(above, sf::FloatRect(1000, 1000, 50, 20));
+	check(hits.hit(sf::Vector2i(110, 105)) == below && hits.hit(sf::Vector2i(1010, 1005)) == above, "moved region");
+	hits.remove(below);
+	check(hits.hit(sf::Vector2i(400, 400)) == NHIT_NONE, "removed region");
+	input_manager.feed(button_event(sf::Event::MouseButtonPressed, sf::Mouse::Left, 1010, 1005));
+	input_manager.feed(button_event(sf::Event::MouseButtonReleased, sf::Mouse::Left, 1010, 1005));
+	input_manager.next_frame();
+	check(hits.dispatch(input_manager.get_frame()) == 1 && clicked_id == 1, "dispatch once per press");
+	clicked_id = -1;
+	input_manager.next_frame();
+	check(hits.dispatch(input_manager.get_frame()) == 0 && clicked_id == -1, "no press, no dispatch");
+	int calls = 0;
+	hits.add(sf::FloatRect(2000, 2000, 50, 20), 0, [&calls](sf::Mouse::Button button, sf::Vector2i const& position) {calls += (button == sf::Mouse::Left && position == sf::Vector2i(2010, 2005)) ? 1 : 100;});
+	input_manager.feed(button_event(sf::Event::MouseButtonPressed, sf::Mouse::Left, 1010, 1005));
+	input_manager.feed(button_event(sf::Event::MouseButtonReleased, sf::Mouse::Left, 1010, 1005));
+	input_manager.feed(button_event(sf::Event::MouseButtonPressed, sf::Mouse::Left, 2010, 2005));
+	input_manager.feed(button_event(sf::Event::MouseButtonReleased, sf::Mouse::Left, 2010, 2005));
+	input_manager.next_frame();
+	check(hits.dispatch(input_manager.get_frame()) == 2 && clicked_id == 1 && calls == 1, "two clicks of a button in one frame are both dispatched");
+	for(int i = 0; i < NINPUT_PRESSES + 4; i++)
+	{
+		input_manager.feed(button_event(sf::Event::MouseButtonPressed, sf::Mouse::Right, 2010, 2005));
+		input_manager.feed(button_event(sf::Event::MouseButtonReleased, sf::Mouse::Right, 2010, 2005));
+	}
+	input_manager.next_frame();
+	check(hits.dispatch(input_manager.get_frame()) == NINPUT_PRESSES, "presses beyond NINPUT_PRESSES are dropped");
+	
+	// negative cells and oversized regions
+	hits.clr();
+	std::size_t negative = hits.add(sf::FloatRect(-100, -100, 50, 50), 0, nullptr);
+	check(hits.hit(sf::Vector2i(-80, -80)) == negative && hits.hit(sf::Vector2i(80, 80)) == NHIT_NONE, "region at negative cells");
+	auto start = std::chrono::steady_clock::now();
+	std::size_t background = hits.add(sf::FloatRect(-50000, -50000, 100000, 100000), 0, nullptr);
+	double add_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "        adding a 100000 x 100000 region: " << add_ms << " ms" << std::endl;
+	check(add_ms < 10.0, "oversized region is not stored in every cell");
+	std::size_t small = hits.add(sf::FloatRect(10, 10, 20, 20), 1, nullptr);
+	std::size_t hidden = hits.add(sf::FloatRect(200, 200, 20, 20), -1, nullptr);
+	check(hits.hit(sf::Vector2i(15, 15)) == small, "higher z wins over an oversized region");
+	check(hits.hit(sf::Vector2i(210, 210)) == background && hits.hit(sf::Vector2i(-80, -80)) == background, "oversized region wins over lower z and older regions");
+	check(hits.hit(sf::Vector2i(49000, -49000)) == background, "oversized region hit far from other regions");
+	hits.move(background, sf::FloatRect(-50000, -50000, 10, 10));
+	check(hits.hit(sf::Vector2i(210, 210)) == hidden && hits.hit(sf::Vector2i(-49995, -49995)) == background, "oversized region moved into a cell");
+	hits.move(background, sf::FloatRect(0, 0, 100000, 100000));
+	hits.remove(background);
+	check(hits.hit(sf::Vector2i(210, 210)) == hidden && hits.hit(sf::Vector2i(5000, 5000)) == NHIT_NONE, "oversized region removed");
+	hits.add(sf::FloatRect(-1e30f, -1e30f, 2e30f, 2e30f), 0, nullptr);
+	check(hits.hit(sf::Vector2i(2000000000, -2000000000)) != NHIT_NONE, "cells of huge bounds are clamped");
+	
+	std::cout << (failed == 0 ? "all passed" : "some failed") << std::endl;
+	return failed;
+}
@@ -0,0 +1,187 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__COMPRESSION__
+#define __NENGINE__NRESOURCE_MANAGER__COMPRESSION__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! cstddef for std::size_t
+// ! cstdint for fixed size integers
+// ! cstring for memcpy
+// ! vector as output buffer
+/////////////////////////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! compresses a block of memory into the LZ4 block format
+// ! the original size is not stored, the caller has to keep track of it
+// @param1: pointer to the data
+// @param2: the size of the data
+// @return: the compressed data
+/////////////////////////////////////////////////////////////////////////////////
+inline auto ncompress(const void* data, std::size_t size) -> std::vector<char>
+{
+	const unsigned char* src = static_cast<const unsigned char*>(data);
+	std::vector<char> dst;
+	dst.reserve(size + (size / 255) + 16);
+
+	// writes a length that did not fit into the token
+	auto write_length = [&dst](std::size_t len)
+	{
+		while(len >= 255)
+		{
+			dst.push_back(static_cast<char>(255));
+			len -= 255;
+		}
+		dst.push_back(static_cast<char>(len));
+	};
+	// writes one sequence: the literals and, if length > 0, the match
+	auto write_sequence = [&](std::size_t anchor, std::size_t literals, std::size_t offset, std::size_t length)
+	{
+		std::size_t match = (length > 0) ? (length - 4) : 0;
+		dst.push_back(static_cast<char>(((literals < 15) ? literals : 15) << 4 | ((match < 15) ? match : 15)));
+		if(literals >= 15)
+			write_length(literals - 15);
+		dst.insert(dst.end(), src + anchor, src + anchor + literals);
+		if(length > 0)
+		{
+			dst.push_back(static_cast<char>(offset & 0xFF));
+			dst.push_back(static_cast<char>((offset >> 8) & 0xFF));
+			if(match >= 15)
+				write_length(match - 15);
+		}
+	};
+
+	// the format requires the last match to start 12 bytes and end 5 bytes before the end
+	const std::size_t none = static_cast<std::size_t>(-1);
+	std::vector<std::size_t> table(1 << 12, none);
+	std::size_t anchor = 0;
+	std::size_t pos = 0;
+	while(size > 12 && pos < size - 12)
+	{
+		std::uint32_t seq;
+		std::memcpy(&seq, src + pos, 4);
+		std::size_t hash = (seq * 2654435761U) >> 20;
+		std::size_t ref = table[hash];
+		table[hash] = pos;
+		if((ref != none) && (pos - ref <= 65535) && (std::memcmp(src + ref, src + pos, 4) == 0))
+		{
+			std::size_t length = 4;
+			while((pos + length < size - 5) && (src[ref + length] == src[pos + length]))
+				length++;
+			write_sequence(anchor, pos - anchor, pos - ref, length);
+			pos += length;
+			anchor = pos;
+		}
+		else
+		{
+			pos++;
+		}
+	}
+	write_sequence(anchor, size - anchor, 0, 0);
+	return dst;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! decompresses a LZ4 block
+// @param1: pointer to the compressed data
+// @param2: the size of the compressed data
+// @param3: pointer to the output buffer
+// @param4: the exact size of the decompressed data
+// @return: indicator if the block was valid and filled the output buffer
+/////////////////////////////////////////////////////////////////////////////////
+inline auto ndecompress(const void* data, std::size_t size, void* output, std::size_t output_size) -> bool
+{
+	const unsigned char* src = static_cast<const unsigned char*>(data);
+	const unsigned char* src_end = src + size;
+	unsigned char* dst = static_cast<unsigned char*>(output);
+	unsigned char* out = dst;
+	unsigned char* dst_end = dst + output_size;
+
+	// reads a length that did not fit into the token
+	auto read_length = [&src, src_end](std::size_t& len) -> bool
+	{
+		unsigned char byte = 255;
+		while(byte == 255)
+		{
+			if(src >= src_end)
+				return false;
+			byte = *src++;
+			len += byte;
+		}
+		return true;
+	};
+
+	while(src < src_end)
+	{
+		unsigned char token = *src++;
+		std::size_t literals = token >> 4;
+		if((literals == 15) && !read_length(literals))
+			return false;
+		if((static_cast<std::size_t>(src_end - src) < literals) || (static_cast<std::size_t>(dst_end - out) < literals))
+			return false;
+		std::memcpy(out, src, literals);
+		src += literals;
+		out += literals;
+		if(src >= src_end) // the last sequence has no match
+			break;
+		if(src_end - src < 2)
+			return false;
+		std::size_t offset = src[0] | (src[1] << 8);
+		src += 2;
+		if((offset == 0) || (offset > static_cast<std::size_t>(out - dst)))
+			return false;
+		std::size_t length = token & 15;
+		if((length == 15) && !read_length(length))
+			return false;
+		length += 4;
+		if(static_cast<std::size_t>(dst_end - out) < length)
+			return false;
+		const unsigned char* match = out - offset;
+		for(std::size_t i = 0; i < length; i++) // byte wise, matches may overlap
+			out[i] = match[i];
+		out += length;
+	}
+	return (out == dst_end);
+}
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__COMPRESSION__
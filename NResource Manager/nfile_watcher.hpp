@@ -0,0 +1,217 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__FILE_WATCHER__
+#define __NENGINE__NRESOURCE_MANAGER__FILE_WATCHER__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! algorithm for reporting every changed file once
+// ! chrono for throttling the modification time polling
+// ! string for the paths
+// ! unordered_map for the watched files and directories
+// ! vector for the changed files
+// ! sys/stat.h for the modification times
+// ! sys/inotify.h and unistd.h for the change events on linux
+/////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the milliseconds between two modification time polls without inotify
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NFILE_WATCHER_INTERVAL
+#define NFILE_WATCHER_INTERVAL 250
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! reports which watched files changed since the last poll
+// ! uses inotify on linux, every other platform compares the modification times
+// ! paths are compared as given, so watch resolved paths
+// ! not thread safe, the owner locks around it
+/////////////////////////////////////////////////////////////////////////////////
+class nfile_watcher
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nfile_watcher(const nfile_watcher&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nfile_watcher& operator=(const nfile_watcher&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		nfile_watcher()
+			: _fd(-1)
+			, _directories()
+			, _files()
+			, _polled()
+		{
+#ifdef __linux__
+			_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom destructor: stops watching
+		/////////////////////////////////////////////////////////////////////////////////
+		~nfile_watcher()
+		{
+#ifdef __linux__
+			if(_fd >= 0)
+				::close(_fd);
+#endif
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! starts watching a file, watching it again does nothing
+		// ! the directory is watched instead of the file, so a file that an editor
+		//   replaces by renaming a new one over it is still reported
+		// @param1: the path to the file
+		/////////////////////////////////////////////////////////////////////////////////
+		auto watch(std::string const& path) -> void
+		{
+			if(_files.count(path) > 0)
+				return;
+			_files[path] = _get_mtime(path);
+#ifdef __linux__
+			if(_fd < 0)
+				return;
+			std::string::size_type slash = path.find_last_of('/');
+			std::string directory = (slash == std::string::npos) ? "." : path.substr(0, slash);
+			int wd = inotify_add_watch(_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if(wd >= 0)
+				_directories[wd] = directory;
+#endif
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! collects the watched files that changed since the last poll
+		// @param1: filled with the paths of the changed files, every path once
+		/////////////////////////////////////////////////////////////////////////////////
+		auto poll(std::vector<std::string>& changed) -> void
+		{
+			changed.clear();
+#ifdef __linux__
+			if(_fd >= 0)
+			{
+				_read_events(changed);
+				return;
+			}
+#endif
+			auto now = std::chrono::steady_clock::now();
+			if(now - _polled < std::chrono::milliseconds(NFILE_WATCHER_INTERVAL))
+				return;
+			_polled = now;
+			for(auto it = _files.begin(); it != _files.end(); it++)
+			{
+				long long mtime = _get_mtime(it->first);
+				if(mtime != it->second)
+				{
+					it->second = mtime;
+					changed.push_back(it->first);
+				}
+			}
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the inotify instance, -1 if the modification times are polled
+		/////////////////////////////////////////////////////////////////////////////////
+		int _fd;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the watched directories by inotify watch descriptor
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unordered_map<int, std::string> _directories;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the watched files with their last known modification time
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unordered_map<std::string, long long> _files;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the time of the last modification time poll
+		/////////////////////////////////////////////////////////////////////////////////
+		std::chrono::steady_clock::time_point _polled;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the modification time of a file
+		// @param1: the path to the file
+		// @return: the modification time or -1 if the file does not exist
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_mtime(std::string const& path) -> long long
+		{
+			struct stat info;
+			if(stat(path.c_str(), &info) != 0)
+				return -1;
+			return static_cast<long long>(info.st_mtime);
+		}
+#ifdef __linux__
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! reads all pending inotify events without blocking
+		// @param1: filled with the paths of the changed watched files
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _read_events(std::vector<std::string>& changed) -> void
+		{
+			alignas(struct inotify_event) char buffer[4096];
+			for(;;)
+			{
+				ssize_t length = ::read(_fd, buffer, sizeof(buffer));
+				if(length <= 0)
+					return;
+				for(ssize_t i = 0; i < length;)
+				{
+					auto event = reinterpret_cast<struct inotify_event*>(buffer + i);
+					i += sizeof(struct inotify_event) + event->len;
+					auto directory = _directories.find(event->wd);
+					if((event->len == 0) || (directory == _directories.end()))
+						continue;
+					std::string path = (directory->second == ".") ? std::string(event->name) : directory->second + "/" + event->name;
+					if((_files.count(path) > 0) && (std::find(changed.begin(), changed.end(), path) == changed.end()))
+						changed.push_back(path);
+				}
+			}
+		}
+#endif
+}; // end of class nfile_watcher
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__FILE_WATCHER__
@@ -0,0 +1,176 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__GLYPH_SET__
+#define __NENGINE__NRESOURCE_MANAGER__GLYPH_SET__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! algorithm for adding every entry once
+// ! vector for the characters, sizes and outlines
+// ! SFML/Graphics.hpp for sfml structures
+/////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the characters, sizes and styles a sf::Font is going to be drawn with
+// ! sf::Text rasterizes a glyph the first time it is drawn, warming a font
+//   rasterizes all of them up front so the first frame showing a text does not
+//   stall
+/////////////////////////////////////////////////////////////////////////////////
+class nglyph_set
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		nglyph_set()
+			: _characters()
+			, _sizes()
+			, _outlines(1, 0.0f)
+			, _bold(false)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds the characters of a string, every character is added once
+		// @param1: the characters
+		// @return: the nglyph_set itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_characters(sf::String const& characters) -> nglyph_set&
+		{
+			for(auto it = characters.begin(); it != characters.end(); it++)
+			{
+				if(std::find(_characters.begin(), _characters.end(), *it) == _characters.end())
+					_characters.push_back(*it);
+			}
+			return *this;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds the printable ascii characters
+		// @return: the nglyph_set itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_ascii() -> nglyph_set&
+		{
+			for(sf::Uint32 character = 32; character < 127; character++)
+			{
+				if(std::find(_characters.begin(), _characters.end(), character) == _characters.end())
+					_characters.push_back(character);
+			}
+			return *this;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a character size
+		// @param1: the character size in pixels
+		// @return: the nglyph_set itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_size(unsigned int size) -> nglyph_set&
+		{
+			if(std::find(_sizes.begin(), _sizes.end(), size) == _sizes.end())
+				_sizes.push_back(size);
+			return *this;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds an outline thickness, the glyphs without outline are always warmed
+		// @param1: the outline thickness
+		// @return: the nglyph_set itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_outline(float thickness) -> nglyph_set&
+		{
+			if(std::find(_outlines.begin(), _outlines.end(), thickness) == _outlines.end())
+				_outlines.push_back(thickness);
+			return *this;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to warm the bold glyphs instead of the regular ones
+		// @param1: indicator if the text is bold
+		// @return: the nglyph_set itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_bold(bool bold) -> nglyph_set&
+		{
+			_bold = bold;
+			return *this;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find out if there is anything to warm
+		// @return: indicator if no character or no size was added
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto is_empty() const -> bool {return (_characters.empty() || _sizes.empty());}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! rasterizes every glyph of the set into the pages of a font
+		// ! the pages are textures, so it has to run on the render thread
+		// @param1: the font
+		// @return: the amount of warmed glyphs
+		/////////////////////////////////////////////////////////////////////////////////
+		auto warm(sf::Font const& font) const -> unsigned int
+		{
+			unsigned int glyphs = 0;
+			for(auto size = _sizes.begin(); size != _sizes.end(); size++)
+			{
+				for(auto outline = _outlines.begin(); outline != _outlines.end(); outline++)
+				{
+					for(auto character = _characters.begin(); character != _characters.end(); character++)
+					{
+						font.getGlyph(*character, *size, _bold, *outline);
+						glyphs++;
+					}
+				}
+			}
+			return glyphs;
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the unicode code points
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<sf::Uint32> _characters;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the character sizes in pixels
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<unsigned int> _sizes;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the outline thicknesses, 0 for the glyphs without outline
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<float> _outlines;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! indicator if the bold glyphs are warmed
+		/////////////////////////////////////////////////////////////////////////////////
+		bool _bold;
+}; // end of class nglyph_set
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__GLYPH_SET__
@@ -0,0 +1,80 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__HASH__
+#define __NENGINE__NRESOURCE_MANAGER__HASH__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! cstddef for std::size_t
+// ! cstdint for fixed size integers
+// ! string for hashing strings
+/////////////////////////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! 64 bit FNV-1a hash of a block of memory
+// @param1: pointer to the first byte
+// @param2: the amount of bytes
+// @param3: the hash to continue from, used to hash data in multiple parts
+// @return: the hash
+/////////////////////////////////////////////////////////////////////////////////
+inline auto nhash(const void* data, std::size_t size, std::uint64_t hash = 14695981039346656037ULL) -> std::uint64_t
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for(std::size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! 64 bit FNV-1a hash of a string
+// @param1: the string
+// @return: the hash
+/////////////////////////////////////////////////////////////////////////////////
+inline auto nhash(std::string const& str) -> std::uint64_t
+{
+	return nhash(str.data(), str.size());
+}
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__HASH__
@@ -0,0 +1,339 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__IMAGE_CACHE__
+#define __NENGINE__NRESOURCE_MANAGER__IMAGE_CACHE__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! ncompression for compressed pixel data
+// ! nhash for the cache file names
+// ! cstdint for fixed size integers
+// ! cstdio for renaming and removing files
+// ! cstring for memcpy
+// ! fstream for reading and writing cache files
+// ! mutex for thread safety
+// ! sstream for building the cache file names
+// ! string for paths
+// ! thread for unique temporary file names
+// ! vector for buffers
+// ! sys/stat.h and direct.h or unistd.h for file times and directories
+// ! SFML/Graphics.hpp for sf::Image
+/////////////////////////////////////////////////////////////////////////////////
+#include "ncompression.hpp"
+#include "nhash.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+#include <SFML/Graphics.hpp>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the layout of a cache file, all numbers in the byte order of the machine
+// ! header:  magic "NIMG", version, width, height, flags, reserved,
+//            path hash, source size, source mtime, stored size
+// ! data:    the RGBA pixels, LZ4 block compressed if NIMAGE_CACHE_COMPRESSED
+/////////////////////////////////////////////////////////////////////////////////
+#define NIMAGE_CACHE_VERSION 1
+#define NIMAGE_CACHE_COMPRESSED 1
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the header of a cache file
+/////////////////////////////////////////////////////////////////////////////////
+struct nimage_cache_header
+{
+	char _magic[4];
+	std::uint32_t _version;
+	std::uint32_t _width;
+	std::uint32_t _height;
+	std::uint32_t _flags;
+	std::uint32_t _reserved;
+	std::uint64_t _path_hash;
+	std::uint64_t _source_size;
+	std::int64_t _source_mtime;
+	std::uint64_t _stored_size;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! an on-disk cache of decoded images
+// ! a cache file is keyed by the source path, size and modification time, so an
+//   edited source is decoded again
+/////////////////////////////////////////////////////////////////////////////////
+class nimage_cache
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nimage_cache(const nimage_cache&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nimage_cache& operator=(const nimage_cache&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list, the cache starts disabled
+		/////////////////////////////////////////////////////////////////////////////////
+		nimage_cache()
+			: _mutex()
+			, _directory()
+			, _compress(true)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! enables the cache, the directory is created if it does not exist
+		// @param1: the directory of the cache files, an empty string disables the cache
+		// @param2: to indicate if the pixels are LZ4 compressed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_directory(std::string const& directory, bool compress) -> void
+		{
+			if(!directory.empty())
+			{
+#ifdef _WIN32
+				_mkdir(directory.c_str());
+#else
+				mkdir(directory.c_str(), 0755);
+#endif
+			}
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_directory = directory;
+				_compress = compress;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find out if the cache is enabled
+		// @return: indicator if a directory is set
+		/////////////////////////////////////////////////////////////////////////////////
+		auto is_enabled() -> bool
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				return !_directory.empty();
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! reads the decoded image of a source file
+		// @param1: the path to the source file
+		// @param2: filled with the decoded image
+		// @return: indicator if an up to date cache file was found
+		/////////////////////////////////////////////////////////////////////////////////
+		auto read(std::string const& path, sf::Image& image) -> bool
+		{
+			std::uint64_t source_size = 0;
+			std::int64_t source_mtime = 0;
+			std::string file_path;
+			if(!_get_source_info(path, source_size, source_mtime) || !_get_file_path(path, file_path))
+				return false;
+			std::ifstream file(file_path.c_str(), std::ios::binary | std::ios::ate);
+			if(!file)
+				return false;
+			std::uint64_t file_size = static_cast<std::uint64_t>(file.tellg());
+			nimage_cache_header header;
+			if(!file.seekg(0) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+				return false;
+			if((std::memcmp(header._magic, "NIMG", 4) != 0) || (header._version != NIMAGE_CACHE_VERSION) || (header._path_hash != nhash(path)) || (header._source_size != source_size) || (header._source_mtime != source_mtime))
+				return false;
+			std::size_t size = 0;
+			if(!_check_header(header, file_size - sizeof(header), size))
+				return false;
+			std::vector<char> stored(static_cast<std::size_t>(header._stored_size));
+			if(!file.read(stored.data(), stored.size()))
+				return false;
+			if((header._flags & NIMAGE_CACHE_COMPRESSED) == 0)
+			{
+				image.create(header._width, header._height, reinterpret_cast<const sf::Uint8*>(stored.data()));
+				return true;
+			}
+			std::vector<char> pixels(size);
+			if(!ndecompress(stored.data(), stored.size(), pixels.data(), pixels.size()))
+				return false;
+			image.create(header._width, header._height, reinterpret_cast<const sf::Uint8*>(pixels.data()));
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! writes the decoded image of a source file
+		// ! the file is written under a temporary name and renamed afterwards, so a
+		//   reader never sees a half written file
+		// @param1: the path to the source file
+		// @param2: the decoded image
+		// @return: indicator if the cache file was written
+		/////////////////////////////////////////////////////////////////////////////////
+		auto write(std::string const& path, sf::Image const& image) -> bool
+		{
+			nimage_cache_header header;
+			std::memset(&header, 0, sizeof(header));
+			std::string file_path;
+			if((image.getSize().x == 0) || (image.getSize().y == 0))
+				return false;
+			if(!_get_source_info(path, header._source_size, header._source_mtime) || !_get_file_path(path, file_path))
+				return false;
+			std::memcpy(header._magic, "NIMG", 4);
+			header._version = NIMAGE_CACHE_VERSION;
+			header._width = image.getSize().x;
+			header._height = image.getSize().y;
+			header._path_hash = nhash(path);
+			const char* pixels = reinterpret_cast<const char*>(image.getPixelsPtr());
+			std::size_t size = static_cast<std::size_t>(header._width) * header._height * 4;
+			std::vector<char> compressed;
+			if(_get_compress())
+			{
+				compressed = ncompress(pixels, size);
+				header._flags = NIMAGE_CACHE_COMPRESSED;
+				header._stored_size = compressed.size();
+			}
+			else
+			{
+				header._stored_size = size;
+			}
+			std::ostringstream tmp_path;
+			tmp_path << file_path << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+			{
+				std::ofstream file(tmp_path.str().c_str(), std::ios::binary | std::ios::trunc);
+				if(!file)
+					return false;
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(compressed.empty() ? pixels : compressed.data(), header._stored_size);
+				if(!file)
+				{
+					file.close();
+					std::remove(tmp_path.str().c_str());
+					return false;
+				}
+			}
+			std::remove(file_path.c_str()); // rename does not replace files on every platform
+			if(std::rename(tmp_path.str().c_str(), file_path.c_str()) != 0)
+			{
+				std::remove(tmp_path.str().c_str());
+				return false;
+			}
+			return true;
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the directory of the cache files, empty if the cache is disabled
+		/////////////////////////////////////////////////////////////////////////////////
+		std::string _directory;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to indicate if new cache files are compressed
+		/////////////////////////////////////////////////////////////////////////////////
+		bool _compress;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the cache file of a source file
+		// @param1: the path to the source file
+		// @param2: filled with the path to the cache file
+		// @return: indicator if the cache is enabled
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_file_path(std::string const& path, std::string& file_path) -> bool
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if(_directory.empty())
+					return false;
+				std::ostringstream stream;
+				stream << _directory << "/" << std::hex << nhash(path) << ".nimg";
+				file_path = stream.str();
+				return true;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find out if new cache files are compressed
+		// @return: indicator if new cache files are compressed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_compress() -> bool
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				return _compress;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check the sizes of a cache file before anything is allocated, a
+		//   truncated or corrupt file is a miss
+		// ! a LZ4 block expands its input at most 255 times, so a compressed size far
+		//   below the pixel size cannot be valid
+		// @param1: the header of the cache file
+		// @param2: the bytes following the header
+		// @param3: filled with the size of the RGBA pixels
+		// @return: indicator if the sizes are consistent
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _check_header(nimage_cache_header const& header, std::uint64_t data_size, std::size_t& size) -> bool
+		{
+			if((header._width == 0) || (header._height == 0) || (header._stored_size != data_size))
+				return false;
+			std::uint64_t pixels = static_cast<std::uint64_t>(header._width) * header._height; // cannot wrap, both are 32 bit
+			if(pixels > static_cast<std::uint64_t>(static_cast<std::size_t>(-1)) / 4)
+				return false;
+			size = static_cast<std::size_t>(pixels * 4);
+			if((header._flags & NIMAGE_CACHE_COMPRESSED) == 0)
+				return header._stored_size == size;
+			return (header._stored_size <= size + size / 255 + 16) && (size / 255 <= header._stored_size);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the size and the modification time of a source file
+		// @param1: the path to the source file
+		// @param2: filled with the size
+		// @param3: filled with the modification time
+		// @return: indicator if the source file exists
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_source_info(std::string const& path, std::uint64_t& size, std::int64_t& mtime) -> bool
+		{
+			struct stat info;
+			if(stat(path.c_str(), &info) != 0)
+				return false;
+			size = static_cast<std::uint64_t>(info.st_size);
+			mtime = static_cast<std::int64_t>(info.st_mtime);
+			return true;
+		}
+}; // end of class nimage_cache
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__IMAGE_CACHE__
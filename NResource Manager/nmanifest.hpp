@@ -0,0 +1,208 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__MANIFEST__
+#define __NENGINE__NRESOURCE_MANAGER__MANIFEST__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! nglyph_set for the glyphs of the listed fonts
+// ! functional for the progress callback
+// ! future for the preload results
+// ! memory for shared pointers
+// ! string for keys and paths
+// ! vector for the entries
+/////////////////////////////////////////////////////////////////////////////////
+#include "nglyph_set.hpp"
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the kinds of SFML resources a nmanifest can list
+/////////////////////////////////////////////////////////////////////////////////
+enum class nmanifest_type
+{
+	TEXTURE,
+	TEXTURE_ATLAS,
+	FONT,
+	SOUNDBUFFER,
+	MUSIC
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a single resource listed in a nmanifest
+// ! _glyphs: the glyphs warmed after loading a font, empty for other kinds
+/////////////////////////////////////////////////////////////////////////////////
+struct nmanifest_entry
+{
+	nmanifest_type _type;
+	std::string _key;
+	std::string _path;
+	nglyph_set _glyphs;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the declarative list of the SFML resources a state needs
+// ! load it all at once with nresource_wrapper::load() or in the background
+//   with nresource_wrapper::preload()
+/////////////////////////////////////////////////////////////////////////////////
+class nmanifest
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		nmanifest()
+			: _entries()
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! lists a sf::Texture
+		// @param1: the key identifier
+		// @param2: the path to the texture
+		// @return: the nmanifest itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_texture(std::string const& key, std::string const& path) -> nmanifest&
+		{
+			return _add(nmanifest_type::TEXTURE, key, path);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! lists a sf::Texture that is packed onto the texture atlas
+		// @param1: the key identifier
+		// @param2: the path to the texture
+		// @return: the nmanifest itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_texture_atlas(std::string const& key, std::string const& path) -> nmanifest&
+		{
+			return _add(nmanifest_type::TEXTURE_ATLAS, key, path);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! lists a sf::Font
+		// @param1: the key identifier
+		// @param2: the path to the font
+		// @param3: the glyphs to be rasterized once the font is loaded, may be empty
+		// @return: the nmanifest itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_font(std::string const& key, std::string const& path, nglyph_set const& glyphs = nglyph_set()) -> nmanifest&
+		{
+			auto size = _entries.size();
+			_add(nmanifest_type::FONT, key, path);
+			if(_entries.size() > size)
+				_entries.back()._glyphs = glyphs;
+			return *this;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! lists a sf::SoundBuffer
+		// @param1: the key identifier
+		// @param2: the path to the sound
+		// @return: the nmanifest itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_soundbuffer(std::string const& key, std::string const& path) -> nmanifest&
+		{
+			return _add(nmanifest_type::SOUNDBUFFER, key, path);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! lists a streamed music
+		// @param1: the key identifier
+		// @param2: the path to the music
+		// @return: the nmanifest itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_music(std::string const& key, std::string const& path) -> nmanifest&
+		{
+			return _add(nmanifest_type::MUSIC, key, path);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get all listed resources
+		// @return: the entries in the order they were added
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_entries() const -> std::vector<nmanifest_entry> const&
+		{
+			return _entries;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the amount of listed resources
+		// @return: the amount of entries
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_size() const -> unsigned int
+		{
+			return _entries.size();
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the listed resources
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<nmanifest_entry> _entries;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! lists a resource, a key that is already listed is skipped
+		// @param1: the kind of resource
+		// @param2: the key identifier
+		// @param3: the path to the resource
+		// @return: the nmanifest itself for chaining
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _add(nmanifest_type type, std::string const& key, std::string const& path) -> nmanifest&
+		{
+			for(auto it = _entries.begin(); it != _entries.end(); it++)
+			{
+				if((it->_type == type) && (it->_key == key))
+					return *this;
+			}
+			nmanifest_entry entry;
+			entry._type = type;
+			entry._key = key;
+			entry._path = path;
+			_entries.push_back(entry);
+			return *this;
+		}
+}; // end of class nmanifest
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a running nresource_wrapper::preload(), polled by nresource_wrapper::process()
+/////////////////////////////////////////////////////////////////////////////////
+struct npreload
+{
+	std::vector<std::shared_future<bool>> _futures;
+	unsigned int _done;
+	unsigned int _total;
+	std::function<void(unsigned int, unsigned int)> _progress;
+	std::shared_ptr<std::promise<bool>> _promise;
+};
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__MANIFEST__
@@ -0,0 +1,167 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__MUSIC__
+#define __NENGINE__NRESOURCE_MANAGER__MUSIC__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! nresource_archive for the mapped archive entries
+// ! memory for shared pointers
+// ! string for the path
+// ! vector for the owned file content
+// ! SFML/Audio.hpp for sfml structures
+/////////////////////////////////////////////////////////////////////////////////
+#include "nresource_archive.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <SFML/Audio.hpp>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the source of a streamed sf::Music: a loose file, a mapped archive entry or
+//   a decompressed archive entry
+// ! nothing is decoded up front, every opened sf::Music decodes its own small
+//   ring of chunks while playing
+/////////////////////////////////////////////////////////////////////////////////
+class nmusic
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nmusic(const nmusic&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nmusic& operator=(const nmusic&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		nmusic()
+			: _path()
+			, _memory()
+			, _archive()
+			, _data(nullptr)
+			, _size(0)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! streams from a loose file
+		// @param1: the path to the file
+		// @return: indicator if the file can be streamed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_from_file(std::string const& path) -> bool
+		{
+			sf::Music music;
+			if(!music.openFromFile(path))
+				return false;
+			_path = path;
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! streams from a mapped archive entry, the nmusic holds the archive so the
+		//   entry stays mapped as long as it is streamed from
+		// @param1: the pointer to the file content
+		// @param2: the size of the file content
+		// @param3: the archive param1 is mapped from, nullptr if param1 outlives the
+		//          nmusic anyway
+		// @return: indicator if the content can be streamed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_from_memory(const char* data, std::size_t size, std::shared_ptr<narchive> archive) -> bool
+		{
+			sf::Music music;
+			if(!music.openFromMemory(data, size))
+				return false;
+			_archive = std::move(archive);
+			_data = data;
+			_size = size;
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! streams from memory owned by the nmusic, e.g. a decompressed archive entry
+		// @param1: the file content to take over
+		// @return: indicator if the content can be streamed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_from_memory(std::vector<char>&& memory) -> bool
+		{
+			auto owned = std::make_shared<std::vector<char>>(std::move(memory));
+			if(!load_from_memory(owned->data(), owned->size(), nullptr))
+				return false;
+			_memory = std::move(owned);
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! opens a sf::Music on the source, it has to be kept alive while it plays
+		// @param1: the sf::Music to open
+		// @return: indicator if the sf::Music could be opened
+		/////////////////////////////////////////////////////////////////////////////////
+		auto open(sf::Music& music) const -> bool
+		{
+			if(_data != nullptr)
+				return music.openFromMemory(_data, _size);
+			if(!_path.empty())
+				return music.openFromFile(_path);
+			return false;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the amount of memory the source owns
+		// @return: the size of the owned file content in bytes
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto get_owned_size() const -> std::size_t {return (_memory != nullptr) ? _memory->size() : 0;}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the path of a loose file
+		/////////////////////////////////////////////////////////////////////////////////
+		std::string _path;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the decompressed file content, empty for loose files and mapped entries
+		/////////////////////////////////////////////////////////////////////////////////
+		std::shared_ptr<std::vector<char>> _memory;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the archive a mapped entry is streamed from, nullptr otherwise
+		/////////////////////////////////////////////////////////////////////////////////
+		std::shared_ptr<narchive> _archive;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the file content streamed from, nullptr for loose files
+		/////////////////////////////////////////////////////////////////////////////////
+		const char* _data;
+		std::size_t _size;
+}; // end of class nmusic
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__MUSIC__
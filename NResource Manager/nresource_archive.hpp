@@ -0,0 +1,549 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__RESOURCE_ARCHIVE__
+#define __NENGINE__NRESOURCE_MANAGER__RESOURCE_ARCHIVE__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! ncompression for compressed entries
+// ! nhash for the hashed index
+// ! cstdint for fixed size integers
+// ! cstring for memcpy
+// ! fstream for reading loose files and writing archives
+// ! iterator for reading whole files
+// ! string for entry names
+// ! vector for buffers
+// ! windows.h or the posix headers for memory mapping
+/////////////////////////////////////////////////////////////////////////////////
+#include "ncompression.hpp"
+#include "nhash.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the layout of a narchive file, the numbers are copied in the byte order of
+//   the machine that packed it, so an archive is only read on machines of the
+//   same byte order, e.g. little endian x86 and arm
+// ! header:  magic "NARC", version, slot count (power of two), reserved
+// ! index:   slot count * narchive_slot, open addressing by name hash
+// ! names:   the entry names without terminator
+// ! data:    the entry blobs, each aligned to NARCHIVE_ALIGNMENT bytes
+/////////////////////////////////////////////////////////////////////////////////
+#define NARCHIVE_VERSION 1
+#define NARCHIVE_HEADER_SIZE 16
+#define NARCHIVE_ALIGNMENT 16
+#define NARCHIVE_COMPRESSED 1
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a single slot of the narchive index, a hash of 0 marks an empty slot
+/////////////////////////////////////////////////////////////////////////////////
+struct narchive_slot
+{
+	std::uint64_t _hash;
+	std::uint64_t _offset;
+	std::uint32_t _stored_size;
+	std::uint32_t _size;
+	std::uint32_t _name_offset;
+	std::uint16_t _name_size;
+	std::uint16_t _flags;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a found narchive entry
+/////////////////////////////////////////////////////////////////////////////////
+struct narchive_entry
+{
+	const char* _data;
+	std::size_t _stored_size;
+	std::size_t _size;
+	bool _compressed;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a read only memory mapped file
+/////////////////////////////////////////////////////////////////////////////////
+class nmapped_file
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nmapped_file(const nmapped_file&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nmapped_file& operator=(const nmapped_file&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		nmapped_file()
+			: _data(nullptr)
+			, _size(0)
+#ifdef _WIN32
+			, _file(INVALID_HANDLE_VALUE)
+			, _mapping(nullptr)
+#endif
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom destructor: unmaps the file
+		/////////////////////////////////////////////////////////////////////////////////
+		~nmapped_file()
+		{
+			close();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! maps a file into memory
+		// @param1: the path to the file
+		// @return: indicator if the file could be mapped
+		/////////////////////////////////////////////////////////////////////////////////
+		auto open(std::string const& path) -> bool
+		{
+			close();
+#ifdef _WIN32
+			_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if(_file == INVALID_HANDLE_VALUE)
+				return false;
+			LARGE_INTEGER size;
+			if(!GetFileSizeEx(_file, &size) || (size.QuadPart == 0))
+			{
+				close();
+				return false;
+			}
+			_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(_mapping == nullptr)
+			{
+				close();
+				return false;
+			}
+			_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+			if(_data == nullptr)
+			{
+				close();
+				return false;
+			}
+			_size = static_cast<std::size_t>(size.QuadPart);
+#else
+			int file = ::open(path.c_str(), O_RDONLY);
+			if(file < 0)
+				return false;
+			struct stat info;
+			if((fstat(file, &info) != 0) || (info.st_size == 0))
+			{
+				::close(file);
+				return false;
+			}
+			void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			::close(file); // the mapping keeps its own reference
+			if(data == MAP_FAILED)
+				return false;
+			_data = static_cast<const char*>(data);
+			_size = static_cast<std::size_t>(info.st_size);
+#endif
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! unmaps the file
+		/////////////////////////////////////////////////////////////////////////////////
+		auto close() -> void
+		{
+#ifdef _WIN32
+			if(_data != nullptr)
+				UnmapViewOfFile(_data);
+			if(_mapping != nullptr)
+				CloseHandle(_mapping);
+			if(_file != INVALID_HANDLE_VALUE)
+				CloseHandle(_file);
+			_mapping = nullptr;
+			_file = INVALID_HANDLE_VALUE;
+#else
+			if(_data != nullptr)
+				munmap(const_cast<char*>(_data), _size);
+#endif
+			_data = nullptr;
+			_size = 0;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the mapped memory
+		// @return: pointer to the first byte, nullptr if nothing is mapped
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto get_data() const -> const char* {return _data;}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the size of the mapped memory
+		// @return: the size in bytes
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto get_size() const -> std::size_t {return _size;}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the mapped memory
+		/////////////////////////////////////////////////////////////////////////////////
+		const char* _data;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the size of the mapped memory
+		/////////////////////////////////////////////////////////////////////////////////
+		std::size_t _size;
+#ifdef _WIN32
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the windows file handle
+		/////////////////////////////////////////////////////////////////////////////////
+		HANDLE _file;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the windows file mapping handle
+		/////////////////////////////////////////////////////////////////////////////////
+		HANDLE _mapping;
+#endif
+}; // end of class nmapped_file
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a read only packed resource archive
+// ! the index is used in place from the mapped file, nothing is parsed on open
+/////////////////////////////////////////////////////////////////////////////////
+class narchive
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		narchive(const narchive&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		narchive& operator=(const narchive&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		narchive()
+			: _file()
+			, _slot_count(0)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! maps an archive and validates its header and index
+		// @param1: the path to the archive
+		// @return: indicator if the archive could be opened
+		/////////////////////////////////////////////////////////////////////////////////
+		auto open(std::string const& path) -> bool
+		{
+			_slot_count = 0;
+			if(!_file.open(path))
+				return false;
+			if((_file.get_size() < NARCHIVE_HEADER_SIZE) || (std::memcmp(_file.get_data(), "NARC", 4) != 0))
+			{
+				_file.close();
+				return false;
+			}
+			std::uint32_t version = 0;
+			std::uint32_t slot_count = 0;
+			std::memcpy(&version, _file.get_data() + 4, 4);
+			std::memcpy(&slot_count, _file.get_data() + 8, 4);
+			if((version != NARCHIVE_VERSION) || (slot_count == 0) || ((slot_count & (slot_count - 1)) != 0)
+				|| (slot_count > (_file.get_size() - NARCHIVE_HEADER_SIZE) / sizeof(narchive_slot)))
+			{
+				_file.close();
+				return false;
+			}
+			_slot_count = slot_count;
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! looks up an entry by name
+		// @param1: the name of the entry
+		// @param2: filled with the entry if it was found
+		// @return: indicator if the entry was found
+		/////////////////////////////////////////////////////////////////////////////////
+		auto find(std::string const& name, narchive_entry& entry) const -> bool
+		{
+			if(_slot_count == 0)
+				return false;
+			std::uint64_t hash = nhash(name);
+			if(hash == 0)
+				hash = 1;
+			for(std::uint32_t i = 0; i < _slot_count; i++)
+			{
+				narchive_slot slot;
+				std::size_t index = (hash + i) & (_slot_count - 1);
+				std::memcpy(&slot, _file.get_data() + NARCHIVE_HEADER_SIZE + index * sizeof(narchive_slot), sizeof(narchive_slot));
+				if(slot._hash == 0)
+					return false;
+				if((slot._hash == hash) && (slot._name_size == name.size())
+					&& (slot._name_size <= _file.get_size()) && (slot._name_offset <= _file.get_size() - slot._name_size)
+					&& (std::memcmp(_file.get_data() + slot._name_offset, name.data(), name.size()) == 0))
+				{
+					// written without a sum, so a corrupt offset cannot wrap around
+					if((slot._stored_size > _file.get_size()) || (slot._offset > _file.get_size() - slot._stored_size))
+						return false;
+					if(((slot._flags & NARCHIVE_COMPRESSED) == 0) && (slot._stored_size != slot._size))
+						return false;
+					entry._data = _file.get_data() + slot._offset;
+					entry._stored_size = slot._stored_size;
+					entry._size = slot._size;
+					entry._compressed = ((slot._flags & NARCHIVE_COMPRESSED) != 0);
+					return true;
+				}
+			}
+			return false;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check whether or not an entry is stored
+		// @param1: the name of the entry
+		// @return: indicates whether or not the entry is stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto test(std::string const& name) const -> bool
+		{
+			narchive_entry entry;
+			return find(name, entry);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! looks up an entry and decompresses it if needed
+		// @param1: the name of the entry
+		// @param2: buffer used for compressed entries
+		// @param3: filled with the pointer to the entry data
+		// @param4: filled with the size of the entry data
+		// @return: indicator if the entry was found and could be decompressed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto read(std::string const& name, std::vector<char>& buffer, const char*& data, std::size_t& size) const -> bool
+		{
+			narchive_entry entry;
+			if(!find(name, entry))
+				return false;
+			if(entry._compressed)
+			{
+				buffer.resize(entry._size);
+				if(!ndecompress(entry._data, entry._stored_size, buffer.data(), buffer.size()))
+					return false;
+				data = buffer.data();
+			}
+			else
+			{
+				data = entry._data; // straight from the mapped file
+			}
+			size = entry._size;
+			return true;
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the mapped archive
+		/////////////////////////////////////////////////////////////////////////////////
+		nmapped_file _file;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the amount of index slots
+		/////////////////////////////////////////////////////////////////////////////////
+		std::uint32_t _slot_count;
+}; // end of class narchive
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! builds a narchive file
+/////////////////////////////////////////////////////////////////////////////////
+class narchive_writer
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		narchive_writer(const narchive_writer&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		narchive_writer& operator=(const narchive_writer&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		narchive_writer()
+			: _names()
+			, _blobs()
+			, _sizes()
+			, _flags()
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a block of memory as entry
+		// @param1: the name of the entry, e.g. the path it is loaded by
+		// @param2: pointer to the data
+		// @param3: the size of the data
+		// @param4: to compress the entry, it is stored raw if that does not save space
+		// @return: indicator if the entry was added, names have to be unique
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add(std::string const& name, const char* data, std::size_t size, bool compress) -> bool
+		{
+			if(name.empty() || (name.size() > 0xFFFF) || (size > 0xFFFFFFFFU))
+				return false;
+			for(auto it = _names.begin(); it != _names.end(); it++)
+				if(*it == name)
+					return false;
+			std::vector<char> blob;
+			std::uint16_t flags = 0;
+			if(compress)
+			{
+				blob = ncompress(data, size);
+				flags = NARCHIVE_COMPRESSED;
+			}
+			if(!compress || (blob.size() >= size))
+			{
+				blob.assign(data, data + size);
+				flags = 0;
+			}
+			_names.push_back(name);
+			_blobs.push_back(std::move(blob));
+			_sizes.push_back(static_cast<std::uint32_t>(size));
+			_flags.push_back(flags);
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a file as entry
+		// @param1: the name of the entry, e.g. the path it is loaded by
+		// @param2: the path to the file
+		// @param3: to compress the entry, it is stored raw if that does not save space
+		// @return: indicator if the file could be read and added
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_file(std::string const& name, std::string const& path, bool compress) -> bool
+		{
+			std::ifstream file(path.c_str(), std::ios::binary);
+			if(!file)
+				return false;
+			std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			return add(name, data.data(), data.size(), compress);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! writes all added entries into an archive
+		// @param1: the path to the archive
+		// @return: indicator if the archive was written
+		/////////////////////////////////////////////////////////////////////////////////
+		auto write(std::string const& path) -> bool
+		{
+			// keep the index at most half full so lookups stay short
+			std::uint32_t slot_count = 1;
+			while(slot_count < _names.size() * 2)
+				slot_count *= 2;
+			std::vector<narchive_slot> slots(slot_count);
+			std::memset(slots.data(), 0, slots.size() * sizeof(narchive_slot));
+
+			std::uint64_t offset = NARCHIVE_HEADER_SIZE + static_cast<std::uint64_t>(slot_count) * sizeof(narchive_slot);
+			std::vector<std::uint32_t> name_offsets;
+			for(auto it = _names.begin(); it != _names.end(); it++)
+			{
+				name_offsets.push_back(static_cast<std::uint32_t>(offset));
+				offset += it->size();
+			}
+			if(offset > 0xFFFFFFFFU)
+				return false;
+			std::vector<std::uint64_t> blob_offsets;
+			for(auto it = _blobs.begin(); it != _blobs.end(); it++)
+			{
+				offset = _align(offset);
+				blob_offsets.push_back(offset);
+				offset += it->size();
+			}
+
+			for(std::size_t i = 0; i < _names.size(); i++)
+			{
+				std::uint64_t hash = nhash(_names[i]);
+				if(hash == 0)
+					hash = 1;
+				std::size_t index = hash & (slot_count - 1);
+				while(slots[index]._hash != 0)
+					index = (index + 1) & (slot_count - 1);
+				slots[index]._hash = hash;
+				slots[index]._offset = blob_offsets[i];
+				slots[index]._stored_size = static_cast<std::uint32_t>(_blobs[i].size());
+				slots[index]._size = _sizes[i];
+				slots[index]._name_offset = name_offsets[i];
+				slots[index]._name_size = static_cast<std::uint16_t>(_names[i].size());
+				slots[index]._flags = _flags[i];
+			}
+
+			std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+			if(!file)
+				return false;
+			std::uint32_t header[4] = {0, NARCHIVE_VERSION, slot_count, 0};
+			std::memcpy(&header[0], "NARC", 4);
+			file.write(reinterpret_cast<const char*>(header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(narchive_slot));
+			for(auto it = _names.begin(); it != _names.end(); it++)
+				file.write(it->data(), it->size());
+			for(std::size_t i = 0; i < _blobs.size(); i++)
+			{
+				std::uint64_t position = static_cast<std::uint64_t>(file.tellp());
+				for(; position < blob_offsets[i]; position++)
+					file.put(0);
+				file.write(_blobs[i].data(), _blobs[i].size());
+			}
+			return static_cast<bool>(file);
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the entry names
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::string> _names;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the stored, possibly compressed, entry data
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::vector<char>> _blobs;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the original entry sizes
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::uint32_t> _sizes;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the entry flags
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::uint16_t> _flags;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! rounds an offset up to the blob alignment
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto _align(std::uint64_t offset) -> std::uint64_t {return (offset + NARCHIVE_ALIGNMENT - 1) & ~static_cast<std::uint64_t>(NARCHIVE_ALIGNMENT - 1);}
+}; // end of class narchive_writer
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__RESOURCE_ARCHIVE__
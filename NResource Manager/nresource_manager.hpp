@@ -27,13 +27,25 @@
 #define __NENGINE__NRESOURCE_MANAGER__RESOURCE_MANAGER__
 
 /////////////////////////////////////////////////////////////////////////////////
+// ! array for the shards
+// ! atomic for the lock free counters
+// ! chrono for the load and lock wait times
+// ! cstddef for std::size_t
+// ! functional for std::hash
 // ! memory for shared pointers
 // ! mutex for thread safety
 // ! unordered map as storage container
+// ! vector for the slots
 /////////////////////////////////////////////////////////////////////////////////
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 /////////////////////////////////////////////////////////////////////////////////
 // ! namespace for the nengine
@@ -45,6 +57,73 @@ namespace nengine {
 /////////////////////////////////////////////////////////////////////////////////
 namespace nresource_manager {
 
+/////////////////////////////////////////////////////////////////////////////////
+// ! the amount of independently locked shards of every nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NRESOURCE_MANAGER_SHARDS
+#define NRESOURCE_MANAGER_SHARDS 16
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the id of a nhandle that does not refer to any key
+/////////////////////////////////////////////////////////////////////////////////
+#define NRESOURCE_INVALID_ID 0xFFFFFFFF
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the amount of buckets of the load time histogram
+// ! bucket 0 counts loads below 1 ms, bucket i loads below 2^i ms and the last
+//   bucket every slower load
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NRESOURCE_LOAD_BUCKETS
+#define NRESOURCE_LOAD_BUCKETS 12
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the amount of memory a value occupies, used for the nresource_manager budget
+// ! specialize it for types that own memory outside of the object itself
+/////////////////////////////////////////////////////////////////////////////////
+template <typename VAL>
+struct nresource_size
+{
+	static auto get(VAL const& val) -> std::size_t {return sizeof(val);}
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the cache counters of a nresource_manager
+// ! _loads: the stored values, _load_time and _load_time_max: the total and the
+//   slowest time reported by record_load() in nanoseconds
+// ! _lock_waits and _lock_wait_time: how often and how long in nanoseconds a
+//   thread waited for a shard lock
+/////////////////////////////////////////////////////////////////////////////////
+struct nresource_stats
+{
+	unsigned long long _hits;
+	unsigned long long _misses;
+	unsigned long long _evictions;
+	unsigned long long _loads;
+	unsigned long long _load_time;
+	unsigned long long _load_time_max;
+	unsigned long long _load_histogram[NRESOURCE_LOAD_BUCKETS];
+	unsigned long long _lock_waits;
+	unsigned long long _lock_wait_time;
+	std::size_t _bytes;
+	std::size_t _budget;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the bookkeeping shared by every slot of one value, see nresource::alias()
+// ! _slots: the amount of slots holding the value
+// ! _bytes: the memory charged to released slots, the last slot to go frees it
+//   and a remaining slot takes it over with claim()
+/////////////////////////////////////////////////////////////////////////////////
+struct nresource_share
+{
+	nresource_share() : _slots(1), _bytes(0) {}
+
+	std::atomic<long> _slots;
+	std::atomic<std::size_t> _bytes;
+};
+
 /////////////////////////////////////////////////////////////////////////////////
 // ! template class nresource for convenience and multiple use
 /////////////////////////////////////////////////////////////////////////////////
@@ -57,9 +136,63 @@ class nresource {
 		/////////////////////////////////////////////////////////////////////////////////
 		nresource(std::shared_ptr<VAL> val)
 			: _val(std::move(val))
+			, _share(std::make_shared<nresource_share>())
+			, _bytes(nresource_size<VAL>::get(*_val))
+			, _stamp(0)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! default constructor: an empty slot without a value
+		/////////////////////////////////////////////////////////////////////////////////
+		nresource()
+			: _val()
+			, _share()
+			, _bytes(0)
+			, _stamp(0)
 		{
 		}
 		/////////////////////////////////////////////////////////////////////////////////
+		// ! to create another slot for the same value
+		// ! an alias does not count the memory of the value a second time
+		// @return: the alias sharing the value
+		/////////////////////////////////////////////////////////////////////////////////
+		auto alias() -> nresource<VAL>
+		{
+			nresource<VAL> res;
+			res._val = _val;
+			res._share = _share;
+			res._share->_slots.fetch_add(1);
+			return res;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to give up the slot before it is emptied
+		// ! the memory charged to the slot is handed over to the other slots of the
+		//   value, so it stays counted while an alias holds the value
+		// @return: the memory freed, everything handed over if it was the last slot
+		/////////////////////////////////////////////////////////////////////////////////
+		auto release() -> std::size_t
+		{
+			if(!_share)
+				return 0;
+			_share->_bytes.fetch_add(_bytes);
+			_bytes = 0;
+			if(_share->_slots.fetch_sub(1) != 1)
+				return 0;
+			return _share->_bytes.exchange(0);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! takes over the memory handed over by released slots of the same value
+		// @return: the memory taken over, it is counted already
+		/////////////////////////////////////////////////////////////////////////////////
+		auto claim() -> std::size_t
+		{
+			if(!_share || (_share->_bytes.load() == 0))
+				return 0;
+			auto bytes = _share->_bytes.exchange(0);
+			_bytes += bytes;
+			return bytes;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
 		// ! to get the resources value
 		// @return: a shared pointer to the value
 		/////////////////////////////////////////////////////////////////////////////////
@@ -67,22 +200,210 @@ class nresource {
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! to change the resources value
 		// @param1: a reference to the new value
+		// @return: the memory freed by the old value
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set(VAL const& val) -> std::size_t
+		{
+			std::size_t freed = _bytes;
+			if(_share->_slots.load() > 1) // aliased, the other keys keep the old value
+				freed = _detach(std::make_shared<VAL>(val));
+			else
+				*_val = val;
+			_bytes = nresource_size<VAL>::get(*_val);
+			return freed;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to change the resources value without a copy
+		// @param1: the new value to move from
+		// @return: the memory freed by the old value
 		/////////////////////////////////////////////////////////////////////////////////
-		inline auto set(VAL const& val) -> void {*_val = val;}
+		auto set(VAL&& val) -> std::size_t
+		{
+			std::size_t freed = _bytes;
+			if(_share->_slots.load() > 1) // aliased, the other keys keep the old value
+				freed = _detach(std::make_shared<VAL>(std::move(val)));
+			else
+				*_val = std::move(val);
+			_bytes = nresource_size<VAL>::get(*_val);
+			return freed;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to give the slot a value of its own, the aliases keep the old one
+		// @param1: the shared pointer to the new value
+		// @return: the memory freed by the old value
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set(std::shared_ptr<VAL> val) -> std::size_t
+		{
+			auto freed = _detach(std::move(val));
+			_bytes = nresource_size<VAL>::get(*_val);
+			return freed;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to change the resources value in place, every holder sees the change
+		// @param1: called with the value, returns if it changed it
+		// @return: the result of param1
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename FUNC>
+		auto update(FUNC func) -> bool
+		{
+			bool changed = func(*_val);
+			if(_bytes > 0) // an alias does not count the memory
+				_bytes = nresource_size<VAL>::get(*_val);
+			return changed;
+		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! to find out if the value is unique
+		// ! to find out if the value is unique, i.e. only held by its slots
 		// @return: indicator if the value is unique
 		/////////////////////////////////////////////////////////////////////////////////
-		inline auto is_unique() -> bool {return _val.unique();}
+		inline auto is_unique() -> bool {return (_val.use_count() <= _share->_slots.load());}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the amount of slots sharing the value, 1 if it is not aliased
+		// @return: the amount of slots
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto get_slots() -> long {return _share->_slots.load();}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find out if a value is stored
+		// @return: indicator if a value is stored
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto is_stored() -> bool {return (_val != nullptr);}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the amount of memory the value occupies
+		// @return: the size in bytes
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto get_bytes() -> std::size_t {return _bytes;}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to mark the value as used
+		// @param1: the current access stamp of the nresource_manager
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto touch(unsigned long long stamp) -> void {_stamp = stamp;}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find out when the value was used last
+		// @return: the access stamp of the last use
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto get_stamp() -> unsigned long long {return _stamp;}
 	private:
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! shared pointer to the value
 		/////////////////////////////////////////////////////////////////////////////////
 		std::shared_ptr<VAL> _val;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the bookkeeping shared with the aliases of the value, see alias()
+		/////////////////////////////////////////////////////////////////////////////////
+		std::shared_ptr<nresource_share> _share;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the amount of memory charged to the slot, 0 for an alias
+		/////////////////////////////////////////////////////////////////////////////////
+		std::size_t _bytes;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the access stamp of the last use
+		/////////////////////////////////////////////////////////////////////////////////
+		unsigned long long _stamp;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! gives an aliased slot a value of its own
+		// @param1: the shared pointer to the new value
+		// @return: the memory freed by the old value
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _detach(std::shared_ptr<VAL> val) -> std::size_t
+		{
+			auto freed = release();
+			_val = std::move(val);
+			_share = std::make_shared<nresource_share>();
+			return freed;
+		}
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a typed handle to an interned nresource_manager key
+// ! a handle stays valid for the lifetime of its nresource_manager, even while
+//   the resource behind it is cleared and added again, its slot is never reused
+/////////////////////////////////////////////////////////////////////////////////
+template <typename VAL>
+struct nhandle
+{
+	/////////////////////////////////////////////////////////////////////////////////
+	// ! default constructor: creates an invalid handle
+	/////////////////////////////////////////////////////////////////////////////////
+	nhandle()
+		: _id(NRESOURCE_INVALID_ID)
+	{
+	}
+	/////////////////////////////////////////////////////////////////////////////////
+	// ! custom constructor: creates a handle to the interned id param1
+	// @param1: the interned id
+	/////////////////////////////////////////////////////////////////////////////////
+	explicit nhandle(unsigned int id)
+		: _id(id)
+	{
+	}
+	/////////////////////////////////////////////////////////////////////////////////
+	// ! to find out if the handle refers to an interned key
+	// @return: indicator if the handle is valid
+	/////////////////////////////////////////////////////////////////////////////////
+	inline auto is_valid() const -> bool {return (_id != NRESOURCE_INVALID_ID);}
+	/////////////////////////////////////////////////////////////////////////////////
+	// ! to compare two handles
+	// @param1: the other handle
+	// @return: indicator if both handles refer to the same key
+	/////////////////////////////////////////////////////////////////////////////////
+	inline auto operator==(nhandle const& other) const -> bool {return (_id == other._id);}
+	inline auto operator!=(nhandle const& other) const -> bool {return (_id != other._id);}
+	/////////////////////////////////////////////////////////////////////////////////
+	// ! the interned id, its shard is _id % NRESOURCE_MANAGER_SHARDS and its slot
+	//   inside the shard is _id / NRESOURCE_MANAGER_SHARDS
+	/////////////////////////////////////////////////////////////////////////////////
+	unsigned int _id;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the neighbours of a slot in the least recently used order of its shard
+/////////////////////////////////////////////////////////////////////////////////
+struct nlru_link
+{
+	unsigned int _prev;
+	unsigned int _next;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! one independently locked part of a nresource_manager
+// ! every key is interned once into a slot index, the slots never move to
+//   another index so a handle lookup is an array index
+// ! the slot of a cleared key goes to the free slots and is reused by the next
+//   new key, unless a handle was handed out for it by intern()
+// ! the stored slots are linked from the least to the most recently used one,
+//   so the next eviction candidate is found without a search
+// ! the keys erased under the lock wait in _erased until the lock is freed and
+//   the erase callback can run
+// ! the padding keeps two shards from sharing a cache line
+/////////////////////////////////////////////////////////////////////////////////
+template <typename KEY, typename VAL>
+struct nresource_shard
+{
+	std::mutex _mutex;
+	std::unordered_map<KEY, unsigned int> _ids;
+	std::vector<nresource<VAL>> _slots;
+	std::vector<nlru_link> _links;
+	std::vector<const KEY*> _keys;
+	std::vector<unsigned int> _generations;
+	std::vector<bool> _pinned;
+	std::vector<unsigned int> _free;
+	std::vector<KEY> _erased;
+	unsigned int _oldest;
+	unsigned int _newest;
+	unsigned int _size;
+	std::size_t _bytes;
+	unsigned long long _hits;
+	unsigned long long _misses;
+	unsigned long long _evictions;
+	unsigned long long _loads;
+	unsigned long long _lock_waits;
+	unsigned long long _lock_wait_time;
+	char _padding[64];
 };
 
 /////////////////////////////////////////////////////////////////////////////////
 // ! template class nresource manager for convenience and multiple use
+// ! the storage is split into NRESOURCE_MANAGER_SHARDS shards chosen by the key
+//   hash, so threads reading different resources rarely wait for each other
 /////////////////////////////////////////////////////////////////////////////////
 template <typename KEY, typename VAL>
 class nresource_manager
@@ -101,11 +422,36 @@ class nresource_manager
 		//   manually is useless
 		/////////////////////////////////////////////////////////////////////////////////
 		nresource_manager()
-			: _resources()
-			, _last_requested_resource()
-			, _mutex()
+			: _shards()
+			, _sentinel(std::make_shared<VAL>())
+			, _last(NRESOURCE_INVALID_ID)
 			, _keep_resources(true)
+			, _budget(0)
+			, _bytes(0)
+			, _stamp(0)
+			, _cursor_mutex()
+			, _cursor_shard(0)
+			, _cursor_slot(0)
+			, _load_time(0)
+			, _load_time_max(0)
+			, _load_histogram()
+			, _on_erase()
 		{
+			for(auto& shard : _shards)
+			{
+				shard._oldest = NRESOURCE_INVALID_ID;
+				shard._newest = NRESOURCE_INVALID_ID;
+				shard._size = 0;
+				shard._bytes = 0;
+				shard._hits = 0;
+				shard._misses = 0;
+				shard._evictions = 0;
+				shard._loads = 0;
+				shard._lock_waits = 0;
+				shard._lock_wait_time = 0;
+			}
+			for(auto& bucket : _load_histogram)
+				bucket.store(0);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! custom destructor: resets every pointed to nresource and the key-value pair
@@ -114,10 +460,20 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		~nresource_manager()
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
-			{ // locked area
-				_resources.clear();
-			} // lock freed
+			for(auto& shard : _shards)
+			{
+				auto lock = _lock(shard);
+				{ // locked area
+					shard._slots.clear();
+					shard._links.clear();
+					shard._keys.clear();
+					shard._generations.clear();
+					shard._pinned.clear();
+					shard._free.clear();
+					shard._erased.clear();
+					shard._ids.clear();
+				} // lock freed
+			}
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! used to toggle the ability to hold on to resources that are currently
@@ -126,10 +482,9 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		auto toggle_resource_storage() -> bool
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
-			{ // locked area
-				return (_keep_resources = !_keep_resources);
-			} // lock freed
+			auto keep = _keep_resources.load();
+			while(!_keep_resources.compare_exchange_weak(keep, !keep));
+			return !keep;
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! used to find out whether or not the nresource storage is active
@@ -137,9 +492,97 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		auto get_resource_storage() -> bool
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
+			return _keep_resources.load();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the callback for every erased key, whichever call erased it
+		// ! the callback runs after the shard lock is freed, so it may lock mutexes
+		//   that are held while this nresource_manager is called
+		// CAUTION: set it before the nresource_manager is shared between threads
+		// @param1: called with the key of every erased value
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_on_erase(std::function<void(KEY const&)> func) -> void
+		{
+			_on_erase = std::move(func);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the memory budget
+		// ! while a budget is set clr_unused() only drops unused resources, least
+		//   recently used first, until the stored resources fit into the budget
+		// @param1: the budget in bytes, 0 disables it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_budget(std::size_t bytes) -> void
+		{
+			_budget.store(bytes);
+			_evict();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get a snapshot of the cache counters
+		// ! every shard is locked on its own, so the snapshot is cheap but the
+		//   counters of different shards may be a few operations apart
+		// @return: hits, misses, evictions, loads, load times, lock waits, the stored
+		//          bytes and the budget
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_stats() -> nresource_stats
+		{
+			nresource_stats stats;
+			stats._hits = 0;
+			stats._misses = 0;
+			stats._evictions = 0;
+			stats._loads = 0;
+			stats._load_time = _load_time.load();
+			stats._load_time_max = _load_time_max.load();
+			for(unsigned int i = 0; i < NRESOURCE_LOAD_BUCKETS; i++)
+				stats._load_histogram[i] = _load_histogram[i].load();
+			stats._lock_waits = 0;
+			stats._lock_wait_time = 0;
+			stats._bytes = _bytes.load();
+			stats._budget = _budget.load();
+			for(auto& shard : _shards)
+			{
+				std::unique_lock<std::mutex> lock(shard._mutex);
+				{ // locked area
+					stats._hits += shard._hits;
+					stats._misses += shard._misses;
+					stats._evictions += shard._evictions;
+					stats._loads += shard._loads;
+					stats._lock_waits += shard._lock_waits;
+					stats._lock_wait_time += shard._lock_wait_time;
+				} // lock freed
+			}
+			return stats;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! reports how long loading a value took, e.g. reading and decoding a file
+		// @param1: the load time
+		/////////////////////////////////////////////////////////////////////////////////
+		auto record_load(std::chrono::nanoseconds time) -> void
+		{
+			auto ns = static_cast<unsigned long long>(time.count());
+			_load_time.fetch_add(ns);
+			auto max = _load_time_max.load();
+			while((ns > max) && !_load_time_max.compare_exchange_weak(max, ns));
+			unsigned int bucket = 0;
+			for(unsigned long long ms = ns / 1000000; (ms > 0) && (bucket < NRESOURCE_LOAD_BUCKETS - 1); ms >>= 1)
+				bucket++;
+			_load_histogram[bucket].fetch_add(1);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! interns a key so it can be looked up by handle
+		// ! the key stays interned for the lifetime of the nresource manager, whether
+		//   or not a resource is stored for it
+		// @param1: the key identifier
+		// @return: the handle to param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto intern(KEY const& key) -> nhandle<VAL>
+		{
+			auto index = _get_shard_index(key);
+			auto& shard = _shards[index];
+			auto lock = _lock(shard);
 			{ // locked area
-				return _keep_resources;
+				auto slot = _intern(shard, key);
+				shard._pinned[slot] = true;
+				return nhandle<VAL>(slot * NRESOURCE_MANAGER_SHARDS + index);
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
@@ -150,14 +593,43 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		auto add(KEY const& key, VAL const& value) -> std::shared_ptr<const VAL>
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
-			{ // locked area
-				if(_in_use(key))
-					return _resources.at(key).get();
-				auto tmp = std::make_shared<VAL>(value);
-				_resources.insert(std::make_pair(key, nresource<VAL>(tmp)));
-				return tmp;
-			} // lock freed
+			return _add(key, [&value]() {return std::make_shared<VAL>(value);});
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a key-value pair to the nresource manager by moving the value in
+		// @param1: the nresource identifier
+		// @param2: the nresource to move from, untouched if param1 is already stored
+		// @return: the shared pointer to the nresource
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add(KEY const& key, VAL&& value) -> std::shared_ptr<const VAL>
+		{
+			return _add(key, [&value]() {return std::make_shared<VAL>(std::move(value));});
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! constructs the value of a key-value pair in place
+		// ! the value is only constructed if param1 is not stored yet
+		// @param1: the nresource identifier
+		// @param2: the arguments forwarded to the constructor of the value
+		// @return: the shared pointer to the nresource
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename... ARGS>
+		auto emplace(KEY const& key, ARGS&&... args) -> std::shared_ptr<const VAL>
+		{
+			return _add(key, [&]() {return std::make_shared<VAL>(std::forward<ARGS>(args)...);});
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! stores an already created value without copying it
+		// ! used for values that are loaded in place and cannot be moved, e.g. SFML
+		//   resources
+		// @param1: the nresource identifier
+		// @param2: the shared pointer to the value, nullptr is not stored
+		// @return: the shared pointer to the nresource
+		/////////////////////////////////////////////////////////////////////////////////
+		auto adopt(KEY const& key, std::shared_ptr<VAL> value) -> std::shared_ptr<const VAL>
+		{
+			if(value == nullptr)
+				return _sentinel;
+			return _add(key, [&value]() {return std::move(value);});
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! adds a key-value pair to the nresource manager
@@ -167,44 +639,107 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		auto add_if(KEY const& key, VAL const& value) -> bool
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
+			{ // locked area
+				auto& slot = shard._slots[_intern(shard, key)];
+				if(slot.is_stored())
+					return false;
+				_insert(shard, slot, std::make_shared<VAL>(value));
+			} // lock freed
+			lock.unlock();
+			_evict();
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! stores the value of another key under param1 as well, both keys share it
+		// ! the value is counted against the budget once, the alias takes over the
+		//   memory when param2 is cleared first, the value is unused once only its
+		//   keys hold it
+		// @param1: the nresource identifier of the alias
+		// @param2: the nresource identifier of the stored value
+		// @return: the shared pointer to the value stored under param1 or nullptr if
+		//          param2 is not stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto alias(KEY const& key, KEY const& existing) -> std::shared_ptr<const VAL>
+		{
+			nresource<VAL> original;
+			auto& from = _get_shard(existing);
+			auto from_lock = _lock(from);
+			{ // locked area
+				auto slot = _find(from, existing);
+				if(slot == nullptr)
+					return nullptr;
+				original = slot->alias(); // joins before the lock is freed, so param2 cannot free the value alone
+			} // lock freed
+			from_lock.unlock();
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
 			{ // locked area
-				// second holds an boolean whether or not the insertion happened
-				return _resources.insert(std::make_pair(key, nresource<VAL>(std::make_shared<VAL>(value)))).second;
+				auto& slot = shard._slots[_intern(shard, key)];
+				if(slot.is_stored())
+				{
+					_bytes.fetch_sub(original.release());
+					return slot.get();
+				}
+				slot = std::move(original);
+				slot.touch(_stamp.load(std::memory_order_relaxed));
+				_link(shard, _get_index(shard, slot));
+				shard._size++;
+				return slot.get();
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! for getting a stored nresource
+		// ! only the shard of param1 is locked and a miss hands out the same empty
+		//   value every time instead of allocating one
 		// @param1: the key identifier for the key-value pair
 		// @return: the value as a constant reference
 		/////////////////////////////////////////////////////////////////////////////////
 		auto get(KEY const& key) -> std::shared_ptr<const VAL>
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
 			{ // locked area
-				if(_in_use(key))
-				{
-					_last_requested_resource = key;
-					return _resources.at(key).get();
-				}
-				else
-				{
-					return std::move(std::make_shared<VAL>());
-				}
+				return _get(shard, _find(shard, key));
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! for getting the last used stored nresource
+		// ! for getting a stored nresource by handle
+		// ! the lookup is an array index, the key is neither hashed nor compared
+		// @param1: the handle returned by intern()
 		// @return: the value as a constant reference
 		/////////////////////////////////////////////////////////////////////////////////
+		auto get(nhandle<VAL> const& handle) -> std::shared_ptr<const VAL>
+		{
+			if(!handle.is_valid())
+				return _sentinel;
+			auto& shard = _shards[handle._id % NRESOURCE_MANAGER_SHARDS];
+			auto lock = _lock(shard);
+			{ // locked area
+				return _get(shard, _find(shard, handle));
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for getting the last used stored nresource
+		// ! only the shard of the last used key is locked
+		// @return: the value as a constant reference, the empty value if the last
+		//          used key was cleared meanwhile
+		/////////////////////////////////////////////////////////////////////////////////
 		auto get_last() -> std::shared_ptr<const VAL>
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
+			auto last_id = _last.load(std::memory_order_relaxed);
+			nhandle<VAL> last(static_cast<unsigned int>(last_id));
+			if(!last.is_valid())
+				return _sentinel;
+			auto& shard = _shards[last._id % NRESOURCE_MANAGER_SHARDS];
+			auto lock = _lock(shard);
 			{ // locked area
-				if(_in_use(_last_requested_resource))
-					return _resources.at(_last_requested_resource).get();
-				else
-					return std::move(std::make_shared<VAL>());
+				auto slot = _find(shard, last);
+				// a reused slot belongs to another key now
+				if((slot == nullptr) || (shard._generations[last._id / NRESOURCE_MANAGER_SHARDS] != static_cast<unsigned int>(last_id >> 32)))
+					return _sentinel;
+				return slot->get();
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
@@ -215,22 +750,109 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		auto swap(KEY const& key, VAL const& value) -> bool
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
 			{ // locked area
-				if(_in_use(key))
+				auto slot = _find(shard, key);
+				if((slot == nullptr) || (*slot->get() == value)) // old vs new value
+					return false;
+				auto bytes = slot->get_bytes();
+				auto freed = slot->set(value);
+				_resize(shard, bytes, slot->get_bytes(), freed);
+			} // lock freed
+			lock.unlock();
+			_evict();
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for swapping nresource values without a copy
+		// @param1: the nresource identifier
+		// @param2: the nresource new value to move from
+		// @return: to indicate whether or not the swap happened
+		/////////////////////////////////////////////////////////////////////////////////
+		auto swap(KEY const& key, VAL&& value) -> bool
+		{
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
+			{ // locked area
+				auto slot = _find(shard, key);
+				if((slot == nullptr) || (*slot->get() == value)) // old vs new value
+					return false;
+				auto bytes = slot->get_bytes();
+				auto freed = slot->set(std::move(value));
+				_resize(shard, bytes, slot->get_bytes(), freed);
+			} // lock freed
+			lock.unlock();
+			_evict();
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for changing a nresource value in place
+		// ! unlike swap() the stored object stays the same, so every shared pointer
+		//   handed out before sees the change, aliases included
+		// @param1: the nresource identifier
+		// @param2: called with the value while the shard is locked, returns if it
+		//          changed the value
+		// @return: to indicate whether or not the value changed
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename FUNC>
+		auto update(KEY const& key, FUNC func) -> bool
+		{
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
+			{ // locked area
+				auto slot = _find(shard, key);
+				if(slot == nullptr)
+					return false;
+				auto bytes = slot->get_bytes();
+				bool changed = slot->update(func);
+				_resize(shard, bytes, slot->get_bytes(), bytes);
+				if(!changed)
+					return false;
+			} // lock freed
+			lock.unlock();
+			_evict();
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for changing the value of one key without touching its aliases
+		// ! a value no other keys than the param4 ones store is changed in place, so
+		//   every shared pointer handed out before sees the change
+		// ! a value shared with further aliases, or one param2 cannot change in
+		//   place, is left to the aliases and the key gets the value created by
+		//   param3 instead
+		// @param1: the nresource identifier
+		// @param2: called with the value while the shard is locked, returns if it
+		//          changed the value
+		// @param3: creates the new value while the shard is locked, returns nullptr
+		//          if it failed
+		// @param4: the amount of keys sharing the value that take the change along,
+		//          param1 included
+		// @return: to indicate whether or not param1 holds the change
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename FUNC, typename FACTORY>
+		auto update_own(KEY const& key, FUNC func, FACTORY factory, std::size_t keys = 1) -> bool
+		{
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
+			{ // locked area
+				auto slot = _find(shard, key);
+				if(slot == nullptr)
+					return false;
+				auto bytes = slot->get_bytes();
+				auto freed = bytes;
+				if((static_cast<std::size_t>(slot->get_slots()) > keys) || !slot->update(func))
 				{
-					auto tmp = *_resources.at(key).get(); // get value of type VAL
-					_resources.at(key).set(value);
-					if(tmp != *_resources.at(key).get()) // old vs new value
-						return true;
-					else
+					auto value = factory();
+					if(value == nullptr)
 						return false;
+					freed = slot->set(std::move(value));
 				}
-				else
-				{
-					return false;
-				}
+				_resize(shard, bytes, slot->get_bytes(), freed);
 			} // lock freed
+			lock.unlock();
+			_evict();
+			return true;
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! for checking the amount of stored resources
@@ -238,10 +860,15 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		auto get_size() -> unsigned int
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
-			{ // locked area
-				return _resources.size();
-			} // lock freed
+			unsigned int size = 0;
+			for(auto& shard : _shards)
+			{
+				auto lock = _lock(shard);
+				{ // locked area
+					size += shard._size;
+				} // lock freed
+			}
+			return size;
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! for deleting a single nresource
@@ -255,38 +882,97 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		auto clr(KEY const& key) -> bool
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
+			if(_keep_resources.load())
+				return false;
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
 			{ // locked area
-				if(_keep_resources)
+				auto slot = _find(shard, key);
+				if(slot == nullptr)
 					return false;
-				else
-					if(_in_use(key))
-						if(_resources.erase(key) == 1)
-							return true;
-						else
-							return false;
-					else
-						return false;
-				// return (_keep_resources) ? false : ((_in_use(key)) ? ((_resources.erase(key) == 1) ? true : false) : false); <-- one line return!!!
+				_erase(shard, *slot);
 			} // lock freed
+			lock.unlock();
+			_notify(shard);
+			return true;
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! for deleting unused resources
+		// ! with a budget set only the least recently used unused resources are
+		//   deleted and only while the stored resources exceed the budget
 		// CAUTION: deletes every currently unused nresource without checking
 		//          nresource storage
 		/////////////////////////////////////////////////////////////////////////////////
 		auto clr_unused() -> void
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
+			// every clear starts a new access period for the least recently used order
+			_stamp.fetch_add(1, std::memory_order_relaxed);
+			if(_budget.load() > 0)
+			{
+				_evict();
+				return;
+			}
+			for(auto& shard : _shards)
+			{
+				auto lock = _lock(shard);
+				{ // locked area
+					for(auto& slot : shard._slots)
+					{
+						if(slot.is_stored() && slot.is_unique())
+							_erase(shard, slot);
+					}
+				} // lock freed
+				lock.unlock();
+				_notify(shard);
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for deleting unused resources a few at a time, e.g. once per frame
+		// ! checks at most param1 slots, starting where the last call stopped, so the
+		//   cost does not grow with the amount of stored resources
+		// ! with a budget set nothing is checked while the stored resources fit into
+		//   it, above it at most param1 least recently used resources are evicted
+		//   or, if they are in use, moved to the back
+		// @param1: the maximum amount of slots to check
+		// @return: indicator if the walk reached the end of the slots and starts over,
+		//          with a budget set if the stored resources fit into it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto clr_unused(std::size_t entries) -> bool
+		{
+			_stamp.fetch_add(1, std::memory_order_relaxed);
+			auto budget = _budget.load();
+			if(budget > 0)
+			{
+				_evict(entries);
+				return (_bytes.load() <= budget);
+			}
+			bool wrapped = false;
+			std::size_t checked = 0;
+			std::unique_lock<std::mutex> cursor_lock(_cursor_mutex);
 			{ // locked area
-				for(auto it = _resources.begin(); it != _resources.end();)
+				while((checked < entries) && !wrapped)
 				{
-					if(it->second.is_unique())
-						it = _resources.erase(it);
-					else
-						it++;
+					auto& shard = _shards[_cursor_shard];
+					auto lock = _lock(shard);
+					{ // locked area
+						for(; (checked < entries) && (_cursor_slot < shard._slots.size()); _cursor_slot++, checked++)
+						{
+							auto& slot = shard._slots[_cursor_slot];
+							if(slot.is_stored() && slot.is_unique())
+								_erase(shard, slot);
+						}
+						if(_cursor_slot >= shard._slots.size())
+						{
+							_cursor_slot = 0;
+							_cursor_shard = (_cursor_shard + 1) % NRESOURCE_MANAGER_SHARDS;
+							wrapped = (_cursor_shard == 0);
+						}
+					} // lock freed
+					lock.unlock();
+					_notify(shard);
 				}
 			} // lock freed
+			return wrapped;
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! to check whether or not the requested nresource is stored
@@ -294,35 +980,401 @@ class nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		auto test(KEY const& key) -> bool
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
+			{ // locked area
+				return (_find(shard, key) != nullptr);
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check whether or not the requested nresource is stored
+		// @param1: the handle returned by intern()
+		// @return: indicates whether or not the requested nresource is stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto test(nhandle<VAL> const& handle) -> bool
+		{
+			if(!handle.is_valid())
+				return false;
+			auto& shard = _shards[handle._id % NRESOURCE_MANAGER_SHARDS];
+			auto lock = _lock(shard);
 			{ // locked area
-				return _in_use(key);
+				return (_find(shard, handle) != nullptr);
 			} // lock freed
 		}
 	private:
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! for thread safety
+		// ! the storage structure, split into independently locked shards
 		/////////////////////////////////////////////////////////////////////////////////
-		std::mutex _mutex;
+		std::array<nresource_shard<KEY, VAL>, NRESOURCE_MANAGER_SHARDS> _shards;
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! the storage structure
+		// ! the empty value handed out for every miss
 		/////////////////////////////////////////////////////////////////////////////////
-		std::unordered_map<KEY, nresource<VAL>> _resources;
+		std::shared_ptr<const VAL> _sentinel;
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! the last used key-value pair by key
+		// ! the interned id of the last used key in the low and the generation of its
+		//   slot in the high 32 bits
 		/////////////////////////////////////////////////////////////////////////////////
-		KEY _last_requested_resource;
+		std::atomic<unsigned long long> _last;
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! decides whether resources that aren't in use at the moment should remain in
 		//   the nresource manager
 		/////////////////////////////////////////////////////////////////////////////////
-		bool _keep_resources;
+		std::atomic<bool> _keep_resources;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the memory budget in bytes, 0 if disabled
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<std::size_t> _budget;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the memory occupied by all stored resources
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<std::size_t> _bytes;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the current access period, increased by every add() and clr_unused()
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<unsigned long long> _stamp;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety of the position of the incremental clr_unused()
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _cursor_mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the shard and slot the next incremental clr_unused() starts at
+		/////////////////////////////////////////////////////////////////////////////////
+		std::size_t _cursor_shard;
+		std::size_t _cursor_slot;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the total and the slowest load time in nanoseconds, see record_load()
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! test if nresource is already in the storage unit
-		// @param1: the key to identify the key-value pair by per reference
-		// @return: indicates whether the nresource is already in the storage unit or not
+		std::atomic<unsigned long long> _load_time;
+		std::atomic<unsigned long long> _load_time_max;
 		/////////////////////////////////////////////////////////////////////////////////
-		inline auto _in_use(KEY const& key) -> bool {return (_resources.find(key) != _resources.end()) ? true : false;}
+		// ! the amount of loads per load time bucket, see NRESOURCE_LOAD_BUCKETS
+		/////////////////////////////////////////////////////////////////////////////////
+		std::array<std::atomic<unsigned long long>, NRESOURCE_LOAD_BUCKETS> _load_histogram;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! called with the key of every erased value, see set_on_erase()
+		/////////////////////////////////////////////////////////////////////////////////
+		std::function<void(KEY const&)> _on_erase;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! locks a shard and counts the time spent waiting for it
+		// ! an uncontended lock costs no clock reads
+		// @param1: the shard
+		// @return: the lock of param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _lock(nresource_shard<KEY, VAL>& shard) -> std::unique_lock<std::mutex>
+		{
+			std::unique_lock<std::mutex> lock(shard._mutex, std::try_to_lock);
+			if(!lock.owns_lock())
+			{
+				auto start = std::chrono::steady_clock::now();
+				lock.lock();
+				shard._lock_waits++;
+				shard._lock_wait_time += static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+			}
+			return lock;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the index of the shard a key is stored in
+		// @param1: the key identifier
+		// @return: the shard index of param1
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto _get_shard_index(KEY const& key) -> unsigned int {return static_cast<unsigned int>(std::hash<KEY>()(key) % NRESOURCE_MANAGER_SHARDS);}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the shard a key is stored in
+		// @param1: the key identifier
+		// @return: the shard of param1
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto _get_shard(KEY const& key) -> nresource_shard<KEY, VAL>& {return _shards[_get_shard_index(key)];}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! interns a key into its shard, the caller holds the lock of param1
+		// ! a free slot is reused before a new one is appended
+		// @param1: the shard of param2
+		// @param2: the key identifier
+		// @return: the slot index of param2 inside param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _intern(nresource_shard<KEY, VAL>& shard, KEY const& key) -> unsigned int
+		{
+			auto it = shard._ids.find(key);
+			if(it != shard._ids.end())
+				return it->second;
+			unsigned int slot = 0;
+			if(!shard._free.empty())
+			{
+				slot = shard._free.back();
+				shard._free.pop_back();
+			}
+			else
+			{
+				slot = static_cast<unsigned int>(shard._slots.size());
+				shard._slots.push_back(nresource<VAL>());
+				shard._links.push_back(nlru_link{NRESOURCE_INVALID_ID, NRESOURCE_INVALID_ID});
+				shard._keys.push_back(nullptr);
+				shard._generations.push_back(0);
+				shard._pinned.push_back(false);
+			}
+			shard._keys[slot] = &shard._ids.insert(std::make_pair(key, slot)).first->first; // nodes do not move
+			return slot;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the index of a slot inside its shard
+		// @param1: the shard of param2
+		// @param2: the slot
+		// @return: the slot index of param2
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto _get_index(nresource_shard<KEY, VAL>& shard, nresource<VAL> const& slot) -> unsigned int {return static_cast<unsigned int>(&slot - shard._slots.data());}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! appends a stored slot as the most recently used one, the caller holds the
+		//   lock of param1
+		// @param1: the shard of param2
+		// @param2: the slot index
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _link(nresource_shard<KEY, VAL>& shard, unsigned int index) -> void
+		{
+			shard._links[index]._prev = shard._newest;
+			shard._links[index]._next = NRESOURCE_INVALID_ID;
+			if(shard._newest != NRESOURCE_INVALID_ID)
+				shard._links[shard._newest]._next = index;
+			else
+				shard._oldest = index;
+			shard._newest = index;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! takes a slot out of the least recently used order, the caller holds the
+		//   lock of param1
+		// @param1: the shard of param2
+		// @param2: the slot index
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _unlink(nresource_shard<KEY, VAL>& shard, unsigned int index) -> void
+		{
+			auto& link = shard._links[index];
+			if(link._prev != NRESOURCE_INVALID_ID)
+				shard._links[link._prev]._next = link._next;
+			else
+				shard._oldest = link._next;
+			if(link._next != NRESOURCE_INVALID_ID)
+				shard._links[link._next]._prev = link._prev;
+			else
+				shard._newest = link._prev;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! marks a stored slot as the most recently used one, the caller holds the
+		//   lock of param1
+		// ! stamps only grow, so every shard stays ordered by stamp
+		// @param1: the shard of param2
+		// @param2: the slot index
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _touch(nresource_shard<KEY, VAL>& shard, unsigned int index) -> void
+		{
+			shard._slots[index].touch(_stamp.load(std::memory_order_relaxed));
+			if(shard._newest != index)
+			{
+				_unlink(shard, index);
+				_link(shard, index);
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find a stored resource, the caller holds the lock of param1
+		// ! a found alias takes over the memory of the released slots of its value
+		// @param1: the shard of param2
+		// @param2: the key identifier
+		// @return: the slot of param2 or nullptr if nothing is stored for it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _find(nresource_shard<KEY, VAL>& shard, KEY const& key) -> nresource<VAL>*
+		{
+			auto it = shard._ids.find(key);
+			if((it == shard._ids.end()) || !shard._slots[it->second].is_stored())
+				return nullptr;
+			shard._bytes += shard._slots[it->second].claim();
+			return &shard._slots[it->second];
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find a stored resource, the caller holds the lock of param1
+		// ! a found alias takes over the memory of the released slots of its value
+		// @param1: the shard of param2
+		// @param2: the handle returned by intern()
+		// @return: the slot of param2 or nullptr if nothing is stored for it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _find(nresource_shard<KEY, VAL>& shard, nhandle<VAL> const& handle) -> nresource<VAL>*
+		{
+			auto index = handle._id / NRESOURCE_MANAGER_SHARDS;
+			if((index >= shard._slots.size()) || !shard._slots[index].is_stored())
+				return nullptr;
+			shard._bytes += shard._slots[index].claim();
+			return &shard._slots[index];
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! counts a lookup and hands out its value, the caller holds the lock of param1
+		// @param1: the shard of param2
+		// @param2: the found slot or nullptr
+		// @return: the value of param2 or the sentinel
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get(nresource_shard<KEY, VAL>& shard, nresource<VAL>* slot) -> std::shared_ptr<const VAL>
+		{
+			if(slot == nullptr)
+			{
+				shard._misses++;
+				return _sentinel;
+			}
+			shard._hits++;
+			auto index = _get_index(shard, *slot);
+			_touch(shard, index);
+			auto id = (static_cast<unsigned long long>(shard._generations[index]) << 32) | (index * NRESOURCE_MANAGER_SHARDS + static_cast<unsigned int>(&shard - _shards.data()));
+			if(_last.load(std::memory_order_relaxed) != id)
+				_last.store(id, std::memory_order_relaxed);
+			return slot->get();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a key-value pair, the value is only created if param1 is not stored
+		// @param1: the nresource identifier
+		// @param2: creates the shared pointer to the value
+		// @return: the shared pointer to the stored nresource
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename FACTORY>
+		auto _add(KEY const& key, FACTORY factory) -> std::shared_ptr<const VAL>
+		{
+			std::shared_ptr<VAL> tmp;
+			auto& shard = _get_shard(key);
+			auto lock = _lock(shard);
+			{ // locked area
+				auto& slot = shard._slots[_intern(shard, key)];
+				if(slot.is_stored())
+					return slot.get();
+				tmp = factory();
+				_insert(shard, slot, tmp);
+			} // lock freed
+			lock.unlock();
+			_evict();
+			return tmp;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! updates the byte counters after a value changed, the caller holds the lock
+		//   of param1
+		// @param1: the shard of the value
+		// @param2: the old size in bytes
+		// @param3: the new size in bytes
+		// @param4: the memory freed by the old value, below param2 if an alias still
+		//          holds it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _resize(nresource_shard<KEY, VAL>& shard, std::size_t from, std::size_t to, std::size_t freed) -> void
+		{
+			shard._bytes = shard._bytes - from + to;
+			_bytes.fetch_add(to);
+			_bytes.fetch_sub(freed);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! stores a value in an empty slot, the caller holds the lock of param1
+		// @param1: the shard of param2
+		// @param2: the slot
+		// @param3: the shared pointer to the value
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _insert(nresource_shard<KEY, VAL>& shard, nresource<VAL>& slot, std::shared_ptr<VAL> value) -> void
+		{
+			slot = nresource<VAL>(std::move(value));
+			slot.touch(_stamp.fetch_add(1, std::memory_order_relaxed) + 1);
+			_link(shard, _get_index(shard, slot));
+			shard._size++;
+			shard._loads++;
+			shard._bytes += slot.get_bytes();
+			_bytes.fetch_add(slot.get_bytes());
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! empties a slot, the caller holds the lock of param1
+		// ! the slot is freed for the next new key unless a handle refers to it, then
+		//   the key stays interned so the handle remains valid
+		// @param1: the shard of param2
+		// @param2: the slot
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _erase(nresource_shard<KEY, VAL>& shard, nresource<VAL>& slot) -> void
+		{
+			auto index = _get_index(shard, slot);
+			if(_on_erase)
+				shard._erased.push_back(*shard._keys[index]);
+			_unlink(shard, index);
+			shard._size--;
+			shard._bytes -= slot.get_bytes();
+			_bytes.fetch_sub(slot.release());
+			slot = nresource<VAL>();
+			if(!shard._pinned[index])
+			{
+				shard._ids.erase(shard._ids.find(*shard._keys[index]));
+				shard._keys[index] = nullptr;
+				shard._generations[index]++;
+				shard._free.push_back(index);
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! runs the erase callback for the keys erased in a shard
+		// ! the caller must not hold the lock of param1
+		// @param1: the shard
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _notify(nresource_shard<KEY, VAL>& shard) -> void
+		{
+			if(!_on_erase)
+				return;
+			std::vector<KEY> erased;
+			auto lock = _lock(shard);
+			{ // locked area
+				std::swap(erased, shard._erased);
+			} // lock freed
+			lock.unlock();
+			for(auto& key : erased)
+				_on_erase(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! drops unused resources, least recently used first, until the stored
+		//   resources fit into the budget
+		// ! every step only compares the front of each shard and evicts one value, a
+		//   value that is in use is moved to the back instead, so the cost grows with
+		//   the evicted values and not with the stored ones
+		// ! locks one shard at a time, so the caller must not hold any shard lock
+		// @param1: the maximum amount of steps, the rest is left to the next call
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _evict(std::size_t steps = static_cast<std::size_t>(-1)) -> void
+		{
+			auto budget = _budget.load();
+			if((budget == 0) || (_bytes.load() <= budget))
+				return;
+			std::size_t skipped = 0;
+			for(std::size_t step = 0; (step < steps) && (_bytes.load() > budget); step++)
+			{
+				std::size_t oldest = NRESOURCE_MANAGER_SHARDS;
+				unsigned long long stamp = 0;
+				std::size_t stored = 0;
+				for(std::size_t i = 0; i < NRESOURCE_MANAGER_SHARDS; i++)
+				{
+					auto lock = _lock(_shards[i]);
+					{ // locked area
+						stored += _shards[i]._size;
+						auto front = _shards[i]._oldest;
+						if((front != NRESOURCE_INVALID_ID) && ((oldest == NRESOURCE_MANAGER_SHARDS) || (_shards[i]._slots[front].get_stamp() < stamp)))
+						{
+							oldest = i;
+							stamp = _shards[i]._slots[front].get_stamp();
+						}
+					} // lock freed
+				}
+				if((oldest == NRESOURCE_MANAGER_SHARDS) || (skipped >= stored)) // every stored value is in use
+					return;
+				auto& shard = _shards[oldest];
+				auto lock = _lock(shard);
+				{ // locked area
+					auto front = shard._oldest;
+					if(front == NRESOURCE_INVALID_ID)
+						continue;
+					if(shard._slots[front].is_unique())
+					{
+						_erase(shard, shard._slots[front]);
+						shard._evictions++;
+					}
+					else
+					{
+						_touch(shard, front);
+						skipped++;
+					}
+				} // lock freed
+				lock.unlock();
+				_notify(shard);
+			}
+		}
 }; // end of class nresource_manager
 
 } // end of namespace nresource_manager
@@ -28,11 +28,56 @@
 
 /////////////////////////////////////////////////////////////////////////////////
 // ! nresource_manager as member
+// ! nresource_archive for loading from packed archives
+// ! nthread_pool for background loading
+// ! ntexture_atlas for packing small textures
+// ! nmanifest for batch loading
+// ! nglyph_set for warming the fonts
+// ! nimage_cache for skipping the image decoding
+// ! nmusic for streamed music
+// ! nfile_watcher for the hot reload
+// ! nhash for the content hashes of the deduplication
+// ! algorithm for watching every key once
+// ! chrono for polling the preload futures, the load times and the stats dump
+// ! climits and cstdlib for resolving canonical paths
+// ! functional for queued texture uploads
+// ! future for asynchronous loading results
+// ! iomanip and ostream for writing the stats
 // ! memory for shared pointers
+// ! mutex for thread safety
+// ! queue for pending texture uploads
+// ! string for the deduplication identifiers
+// ! thread for the hardware concurrency
+// ! unordered_map for the first key of every loaded file and content and the
+//   keys of every watched file
+// ! vector for the mounted archives and the running preloads
 // ! SFML/Graphics.hpp for sfml structures
 /////////////////////////////////////////////////////////////////////////////////
 #include "nresource_manager.hpp"
+#include "nresource_archive.hpp"
+#include "nthread_pool.hpp"
+#include "ntexture_atlas.hpp"
+#include "nmanifest.hpp"
+#include "nglyph_set.hpp"
+#include "nimage_cache.hpp"
+#include "nmusic.hpp"
+#include "nfile_watcher.hpp"
+#include "nhash.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <ostream>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 
@@ -52,6 +97,71 @@ namespace nresource_manager {
 using namespace nengine;
 using namespace nengine::nresource_manager;
 
+/////////////////////////////////////////////////////////////////////////////////
+// ! a sf::Texture occupies four bytes per pixel on the graphics card
+/////////////////////////////////////////////////////////////////////////////////
+template <>
+struct nresource_size<sf::Texture>
+{
+	static auto get(sf::Texture const& tex) -> std::size_t {return (sizeof(tex) + (static_cast<std::size_t>(tex.getSize().x) * tex.getSize().y * 4));}
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a sf::SoundBuffer occupies two bytes per sample
+/////////////////////////////////////////////////////////////////////////////////
+template <>
+struct nresource_size<sf::SoundBuffer>
+{
+	static auto get(sf::SoundBuffer const& buffer) -> std::size_t {return (sizeof(buffer) + (static_cast<std::size_t>(buffer.getSampleCount()) * sizeof(sf::Int16)));}
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a nmusic only owns the content of a compressed archive entry, the decoded
+//   samples live in the ring of every opened sf::Music
+/////////////////////////////////////////////////////////////////////////////////
+template <>
+struct nresource_size<nmusic>
+{
+	static auto get(nmusic const& music) -> std::size_t {return (sizeof(music) + music.get_owned_size());}
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! struct ndedup_stats to report what the deduplication saved
+// ! _aliases: loads that were served by an already stored resource
+// ! _bytes_saved: memory those loads would have occupied
+/////////////////////////////////////////////////////////////////////////////////
+struct ndedup_stats
+{
+	unsigned int _aliases;
+	std::size_t _bytes_saved;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! struct nupload for work that has to run on the render thread
+// ! _upload: the work
+// ! _promise: the promise of the asynchronous load it completes, may be empty
+/////////////////////////////////////////////////////////////////////////////////
+struct nupload
+{
+	std::function<void()> _upload;
+	std::shared_ptr<std::promise<bool>> _promise;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! struct nresource_snapshot with the counters of every resource kind
+/////////////////////////////////////////////////////////////////////////////////
+struct nresource_snapshot
+{
+	nresource_stats _resources;
+	nresource_stats _textures;
+	nresource_stats _regions;
+	nresource_stats _fonts;
+	nresource_stats _soundbuffers;
+	nresource_stats _musics;
+	natlas_stats _atlas;
+	ndedup_stats _dedup;
+};
+
 /////////////////////////////////////////////////////////////////////////////////
 // ! template class nresource manager for convenience and multiple use
 /////////////////////////////////////////////////////////////////////////////////
@@ -73,7 +183,52 @@ class nresource_wrapper : public nresource_manager<std::string, VAL>
 		/////////////////////////////////////////////////////////////////////////////////
 		nresource_wrapper()
 			: _nresources()
+			, _ntextures()
+			, _nfonts()
+			, _nsoundbuffers()
+			, _nmusics()
+			, _nregions()
+			, _atlas(std::make_shared<ntexture_atlas>())
+			, _image_cache()
+			, _origins()
+			, _remembered()
+			, _dedup()
+			, _watcher()
+			, _reloads()
+			, _hot_reload(false)
+			, _dump()
+			, _dump_interval(0)
+			, _dumped(std::chrono::steady_clock::now())
+			, _mutex()
+			, _loading()
+			, _uploads()
+			, _preloads()
+			, _archives()
+			, _pool_flag()
+			, _pool()
 		{
+			_ntextures.set_on_erase([this](std::string const& key) {_forget(key, {"texture:", "texture#", "atlas:", "atlas#"});});
+			_nfonts.set_on_erase([this](std::string const& key) {_forget(key, {"font:"});});
+			_nsoundbuffers.set_on_erase([this](std::string const& key) {_forget(key, {"soundbuffer:", "soundbuffer#"});});
+			_nmusics.set_on_erase([this](std::string const& key) {_forget(key, {"music:"});});
+			_nregions.set_on_erase([this](std::string const& key) {_forget(key, {"atlas:", "atlas#"});});
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom destructor: finishes the queued background loads and fails the
+		//   uploads and preloads that were not processed, so no future is left
+		//   without a value
+		/////////////////////////////////////////////////////////////////////////////////
+		~nresource_wrapper()
+		{
+			_pool.reset();
+			while(!_uploads.empty())
+			{
+				if(_uploads.front()._promise != nullptr)
+					_uploads.front()._promise->set_value(false);
+				_uploads.pop();
+			}
+			for(auto it = _preloads.begin(); it != _preloads.end(); it++)
+				it->_promise->set_value(false);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! used to toggle the ability to hold on to resources that are currently
@@ -103,6 +258,27 @@ class nresource_wrapper : public nresource_manager<std::string, VAL>
 			return _nresources.add(key, value);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a key-value pair to the nresource wrapper by moving the value in
+		// @param1: the key identifier for the key-value pair
+		// @param2: the value of the resource to move from
+		// @return: a shared pointer to the resource
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add(std::string const& key, VAL&& value) -> std::shared_ptr<const VAL>
+		{
+			return _nresources.add(key, std::move(value));
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! constructs the value of a key-value pair in place
+		// @param1: the key identifier for the key-value pair
+		// @param2: the arguments forwarded to the constructor of the value
+		// @return: a shared pointer to the resource
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename... ARGS>
+		auto emplace(std::string const& key, ARGS&&... args) -> std::shared_ptr<const VAL>
+		{
+			return _nresources.emplace(key, std::forward<ARGS>(args)...);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
 		// ! adds a key-value pair to the nresource manager
 		// @param1: the key identifier for the key-value pair
 		// @param2: the value of the resource
@@ -113,20 +289,42 @@ class nresource_wrapper : public nresource_manager<std::string, VAL>
 			return _nresources.add_if(key, value);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
+		// ! stores the value of another key under a second key, both keys share it
+		// @param1: the key identifier of the alias
+		// @param2: the key identifier of the stored value
+		// @return: the shared pointer to the value stored under param1 or nullptr if
+		//          param2 is not stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto alias(std::string const& key, std::string const& existing) -> std::shared_ptr<const VAL>
+		{
+			return _nresources.alias(key, existing);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
 		// ! for getting a stored nresource
 		// @param1: the key identifier for the key-value pair
 		// @return: the value as a constant reference
 		/////////////////////////////////////////////////////////////////////////////////
 		auto get(std::string const& key) -> std::shared_ptr<const VAL>
 		{
-			if(_nresources.test(key))
-			{
-				return _nresources.get(key);
-			}
-			else
-			{
-				return std::move(std::make_shared<VAL>());
-			}
+			return _nresources.get(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! interns a "wildcard" key so it can be looked up by handle
+		// @param1: the key identifier for the key-value pair
+		// @return: the handle to param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto intern(std::string const& key) -> nhandle<VAL>
+		{
+			return _nresources.intern(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for getting a stored nresource by handle
+		// @param1: the handle returned by intern()
+		// @return: the value as a constant reference
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get(nhandle<VAL> const& handle) -> std::shared_ptr<const VAL>
+		{
+			return _nresources.get(handle);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! for getting the last used stored nresource
@@ -147,12 +345,22 @@ class nresource_wrapper : public nresource_manager<std::string, VAL>
 			return _nresources.swap(key, value);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
+		// ! for swapping nresource values without a copy
+		// @param1: the nresource identifier
+		// @param2: the nresource new value to move from
+		// @return: to indicate whether or not the swap happened
+		/////////////////////////////////////////////////////////////////////////////////
+		auto swap(std::string const& key, VAL&& value) -> bool
+		{
+			return _nresources.swap(key, std::move(value));
+		}
+		/////////////////////////////////////////////////////////////////////////////////
 		// ! for checking the amount of stored resources
 		// @return: the amount of stored resources
 		/////////////////////////////////////////////////////////////////////////////////
 		auto get_size() -> unsigned int
 		{
-			return (_nresources.get_size() + _ntextures.get_size() + _nfonts.get_size() + _nsoundbuffers.get_size());
+			return (_nresources.get_size() + _ntextures.get_size() + _nfonts.get_size() + _nsoundbuffers.get_size() + _nmusics.get_size() + _nregions.get_size());
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! for deleting a single nresource
@@ -179,6 +387,25 @@ class nresource_wrapper : public nresource_manager<std::string, VAL>
 			_ntextures.clr_unused();
 			_nfonts.clr_unused();
 			_nsoundbuffers.clr_unused();
+			_nmusics.clr_unused();
+			_nregions.clr_unused();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for deleting unused resources a few at a time, e.g. once per frame
+		// ! every resource kind checks at most param1 slots, starting where the last
+		//   call stopped, or evicts at most param1 resources if it has a budget, so
+		//   the cost does not grow with the amount of resources
+		// CAUTION: deletes unused nresources without checking nresource storage
+		// @param1: the maximum amount of slots to check per resource kind
+		/////////////////////////////////////////////////////////////////////////////////
+		auto clr_unused(std::size_t entries) -> void
+		{
+			_nresources.clr_unused(entries);
+			_ntextures.clr_unused(entries);
+			_nfonts.clr_unused(entries);
+			_nsoundbuffers.clr_unused(entries);
+			_nmusics.clr_unused(entries);
+			_nregions.clr_unused(entries);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! to check whether or not the requested nresource is stored
@@ -189,17 +416,231 @@ class nresource_wrapper : public nresource_manager<std::string, VAL>
 			return _nresources.test(key);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
+		// ! to check whether or not the requested nresource is stored
+		// @param1: the handle returned by intern()
+		// @return: indicates whether or not the requested nresource is stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto test(nhandle<VAL> const& handle) -> bool
+		{
+			return _nresources.test(handle);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the memory budget of the wildcard resources
+		// @param1: the budget in bytes, 0 disables it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_budget(std::size_t bytes) -> void
+		{
+			_nresources.set_budget(bytes);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the cache counters of the wildcard resources
+		// @return: hits, misses, evictions, the stored bytes and the budget
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_stats() -> nresource_stats
+		{
+			return _nresources.get_stats();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! mounts a packed narchive
+		// ! every load looks up its path in the mounted archives first and only
+		//   falls back to the loose file if no archive contains it
+		// @param1: the path to the archive
+		// @return: indicator if the archive could be mounted
+		/////////////////////////////////////////////////////////////////////////////////
+		auto mount_archive(std::string const& path) -> bool
+		{
+			auto archive = std::make_shared<narchive>();
+			if(!archive->open(path))
+			{
+				return false;
+			}
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_archives.push_back(archive);
+			} // lock freed
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
 		// ! loads a sf::Texture
 		// @param1: the key identifier
 		// @param2: the path to the texture to be loaded
 		/////////////////////////////////////////////////////////////////////////////////
 		auto load_texture(std::string const& key, std::string const& path) -> void
 		{
-			sf::Texture tex;
-			if(tex.loadFromFile(path))
+			if(_ntextures.test(key))
+			{
+				return;
+			}
+			if(_dedupe(_ntextures, _get_dedup_id("texture", path), key))
+			{
+				_watch(path, key);
+				return;
+			}
+			auto start = std::chrono::steady_clock::now();
+			sf::Image img;
+			if(_load_image(img, path) && _add_texture(key, path, img, _hash_image(img)))
+			{
+				_ntextures.record_load(_get_elapsed(start));
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a sf::Texture in the background
+		// ! the file is read and decoded on a worker thread, the upload to the
+		//   graphics card happens at the next call of process()
+		// @param1: the key identifier
+		// @param2: the path to the texture to be loaded
+		// @return: a future that holds true once the texture is stored, the future
+		//          of a running load of param1 is shared
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_texture_async(std::string const& key, std::string const& path) -> std::shared_future<bool>
+		{
+			std::shared_future<bool> future;
+			auto id = "texture:" + key;
+			auto promise = _begin_load(id, future);
+			if(promise == nullptr)
+			{
+				return future;
+			}
+			if(_ntextures.test(key))
+			{
+				_end_load(id, promise, true);
+				return future;
+			}
+			if(_dedupe(_ntextures, _get_dedup_id("texture", path), key))
+			{
+				_watch(path, key);
+				_end_load(id, promise, true);
+				return future;
+			}
+			_get_pool().push([this, id, key, path, promise]()
+			{
+				auto start = std::chrono::steady_clock::now();
+				auto img = std::make_shared<sf::Image>();
+				if(!_load_image(*img, path))
+				{
+					_end_load(id, promise, false);
+					return;
+				}
+				auto hash = _hash_image(*img); // hashed on the worker, the render thread only uploads
+				auto decoded = _get_elapsed(start);
+				_add_upload([this, id, key, path, img, hash, promise, decoded]()
+				{
+					auto start = std::chrono::steady_clock::now();
+					bool stored = _add_texture(key, path, *img, hash);
+					if(stored)
+						_ntextures.record_load(decoded + _get_elapsed(start));
+					_end_load(id, promise, stored);
+				}, promise);
+			});
+			return future;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! processes all work that has to happen on the render thread
+		// ! uploads every texture decoded by load_texture_async() since the last call
+		// ! call it once per frame, e.g. right after nstate_manager::process()
+		/////////////////////////////////////////////////////////////////////////////////
+		auto process() -> void
+		{
+			_poll_reloads();
+			std::queue<nupload> uploads;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				std::swap(uploads, _uploads);
+			} // lock freed
+			lock.unlock();
+			while(!uploads.empty())
+			{
+				uploads.front()._upload();
+				uploads.pop();
+			}
+			_poll_preloads();
+			_poll_dump();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads every resource listed in a manifest that is not stored yet
+		// @param1: the manifest
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load(nmanifest const& manifest) -> void
+		{
+			for(auto const& entry : manifest.get_entries())
+			{
+				switch(entry._type)
+				{
+					case nmanifest_type::TEXTURE:
+						load_texture(entry._key, entry._path);
+						break;
+					case nmanifest_type::TEXTURE_ATLAS:
+						load_texture_atlas(entry._key, entry._path);
+						break;
+					case nmanifest_type::FONT:
+						load_font(entry._key, entry._path, entry._glyphs);
+						break;
+					case nmanifest_type::SOUNDBUFFER:
+						load_soundbuffer(entry._key, entry._path);
+						break;
+					case nmanifest_type::MUSIC:
+						load_music(entry._key, entry._path);
+						break;
+				}
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads every resource listed in a manifest that is not stored yet in the
+		//   background
+		// ! already stored resources count as loaded, the progress is reported by
+		//   process() on the render thread
+		// @param1: the manifest
+		// @param2: called with the loaded and the total amount of resources whenever
+		//          the amount of loaded resources changes, may be empty
+		// @return: a future that holds true once every resource is stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto preload(nmanifest const& manifest, std::function<void(unsigned int, unsigned int)> progress = nullptr) -> std::shared_future<bool>
+		{
+			npreload batch;
+			batch._done = 0;
+			batch._total = manifest.get_size();
+			batch._progress = std::move(progress);
+			batch._promise = std::make_shared<std::promise<bool>>();
+			std::shared_future<bool> future = batch._promise->get_future().share();
+			for(auto const& entry : manifest.get_entries())
+			{
+				switch(entry._type)
+				{
+					case nmanifest_type::TEXTURE:
+						if(!_ntextures.test(entry._key))
+							batch._futures.push_back(load_texture_async(entry._key, entry._path));
+						break;
+					case nmanifest_type::TEXTURE_ATLAS:
+						if(!_nregions.test(entry._key) && !_ntextures.test(entry._key))
+							batch._futures.push_back(load_texture_atlas_async(entry._key, entry._path));
+						break;
+					case nmanifest_type::FONT:
+						if(!_nfonts.test(entry._key) || !entry._glyphs.is_empty())
+							batch._futures.push_back(load_font_async(entry._key, entry._path, entry._glyphs));
+						break;
+					case nmanifest_type::SOUNDBUFFER:
+						if(!_nsoundbuffers.test(entry._key))
+							batch._futures.push_back(load_soundbuffer_async(entry._key, entry._path));
+						break;
+					case nmanifest_type::MUSIC:
+						if(!_nmusics.test(entry._key))
+							batch._futures.push_back(load_music_async(entry._key, entry._path));
+						break;
+				}
+			}
+			batch._done = batch._total - batch._futures.size();
+			if(batch._futures.empty())
 			{
-				_ntextures.add(key, tex);
+				if(batch._progress)
+					batch._progress(batch._done, batch._total);
+				batch._promise->set_value(true);
+				return future;
 			}
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_preloads.push_back(std::move(batch));
+			} // lock freed
+			return future;
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! to get a sf::Texture
@@ -220,17 +661,324 @@ class nresource_wrapper : public nresource_manager<std::string, VAL>
 			return _ntextures.get(key);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
+		// ! interns a sf::Texture key so it can be looked up by handle
+		// @param1: the key identifier
+		// @return: the handle to param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto intern_texture(std::string const& key) -> nhandle<sf::Texture>
+		{
+			return _ntextures.intern(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get a sf::Texture by handle
+		// @param1: the handle returned by intern_texture()
+		// @return: the sf::Texture identified by param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_texture(nhandle<sf::Texture> const& handle) -> sf::Texture const&
+		{
+			return *_ntextures.get(handle);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get a sf::Texture by handle as shared pointer
+		// @param1: the handle returned by intern_texture()
+		// @return: the sf::Texture identified by param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_texture_p(nhandle<sf::Texture> const& handle) -> std::shared_ptr<const sf::Texture>
+		{
+			return _ntextures.get(handle);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a sf::Texture onto a shared atlas page
+		// ! textures that do not fit on a page are loaded as a standalone texture
+		// ! access it with get_texture_region()
+		// @param1: the key identifier
+		// @param2: the path to the texture to be loaded
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_texture_atlas(std::string const& key, std::string const& path) -> void
+		{
+			if(_nregions.test(key) || _ntextures.test(key))
+			{
+				return;
+			}
+			if(_dedupe_atlas(_get_dedup_id("atlas", path), key))
+			{
+				_watch(path, key);
+				return;
+			}
+			auto start = std::chrono::steady_clock::now();
+			sf::Image img;
+			if(_load_image(img, path) && _add_texture_atlas(key, path, img, _hash_image(img)))
+			{
+				_nregions.record_load(_get_elapsed(start));
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a sf::Texture onto a shared atlas page in the background
+		// ! the file is decoded on a worker thread, the packing happens at the next
+		//   call of process()
+		// @param1: the key identifier
+		// @param2: the path to the texture to be loaded
+		// @return: a future that holds true once the texture is stored, the future
+		//          of a running load of param1 is shared
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_texture_atlas_async(std::string const& key, std::string const& path) -> std::shared_future<bool>
+		{
+			std::shared_future<bool> future;
+			auto id = "atlas:" + key;
+			auto promise = _begin_load(id, future);
+			if(promise == nullptr)
+			{
+				return future;
+			}
+			if(_nregions.test(key) || _ntextures.test(key))
+			{
+				_end_load(id, promise, true);
+				return future;
+			}
+			if(_dedupe_atlas(_get_dedup_id("atlas", path), key))
+			{
+				_watch(path, key);
+				_end_load(id, promise, true);
+				return future;
+			}
+			_get_pool().push([this, id, key, path, promise]()
+			{
+				auto start = std::chrono::steady_clock::now();
+				auto img = std::make_shared<sf::Image>();
+				if(!_load_image(*img, path))
+				{
+					_end_load(id, promise, false);
+					return;
+				}
+				auto hash = _hash_image(*img); // hashed on the worker, the render thread only uploads
+				auto decoded = _get_elapsed(start);
+				_add_upload([this, id, key, path, img, hash, promise, decoded]()
+				{
+					auto start = std::chrono::steady_clock::now();
+					bool stored = _add_texture_atlas(key, path, *img, hash);
+					if(stored)
+						_nregions.record_load(decoded + _get_elapsed(start));
+					_end_load(id, promise, stored);
+				}, promise);
+			});
+			return future;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the texture and sub-rect a sf::Texture is drawn from
+		// ! works for atlas and standalone textures, the rect of a standalone texture
+		//   covers all of it
+		// @param1: the key identifier
+		// @return: the ntexture_region identified by param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_texture_region(std::string const& key) -> std::shared_ptr<const ntexture_region>
+		{
+			if(_nregions.test(key))
+			{
+				return _nregions.get(key);
+			}
+			auto region = std::make_shared<ntexture_region>();
+			region->_texture = _ntextures.get(key);
+			region->_rect = sf::IntRect(0, 0, region->_texture->getSize().x, region->_texture->getSize().y);
+			return region;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the packing statistics of the texture atlas
+		// @return: pages, packed textures, pack efficiency and the upper bound of
+		//          texture switches saved per frame
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_atlas_stats() -> natlas_stats
+		{
+			return _atlas->get_stats();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get what the deduplication saved so far
+		// ! a resource loaded again under another key, from the same file or with the
+		//   same content, is stored as alias of the first key instead of a copy
+		// @return: the aliased loads and the bytes they would have occupied
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_dedup_stats() -> ndedup_stats
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				return _dedup;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get a snapshot of the counters of every resource kind
+		// ! atlas textures are counted by _regions, unless they did not fit onto a
+		//   page and are stored as standalone texture
+		// @return: the snapshot
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_snapshot() -> nresource_snapshot
+		{
+			nresource_snapshot snapshot;
+			snapshot._resources = _nresources.get_stats();
+			snapshot._textures = _ntextures.get_stats();
+			snapshot._regions = _nregions.get_stats();
+			snapshot._fonts = _nfonts.get_stats();
+			snapshot._soundbuffers = _nsoundbuffers.get_stats();
+			snapshot._musics = _nmusics.get_stats();
+			snapshot._atlas = _atlas->get_stats();
+			snapshot._dedup = get_dedup_stats();
+			return snapshot;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! writes a snapshot of the counters of every resource kind, one line per kind
+		// @param1: the stream to write to
+		/////////////////////////////////////////////////////////////////////////////////
+		auto dump_stats(std::ostream& stream) -> void
+		{
+			auto snapshot = get_snapshot();
+			_dump_stats(stream, "resources", snapshot._resources);
+			_dump_stats(stream, "textures", snapshot._textures);
+			_dump_stats(stream, "atlas", snapshot._regions);
+			_dump_stats(stream, "fonts", snapshot._fonts);
+			_dump_stats(stream, "soundbuffers", snapshot._soundbuffers);
+			_dump_stats(stream, "music", snapshot._musics);
+			stream << "atlas pages " << snapshot._atlas._pages << ", efficiency " << std::fixed << std::setprecision(2) << snapshot._atlas._efficiency
+				<< ", dedup aliases " << snapshot._dedup._aliases << " saving " << (snapshot._dedup._bytes_saved / 1024) << " KiB" << std::endl;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! calls param2 with a snapshot every param1 milliseconds from process()
+		// @param1: the interval in milliseconds, 0 disables the dump
+		// @param2: called with the snapshot, e.g. to log it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_stats_dump(unsigned int milliseconds, std::function<void(nresource_snapshot const&)> dump) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_dump_interval = milliseconds;
+				_dump = std::move(dump);
+				_dumped = std::chrono::steady_clock::now();
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! enables the on-disk cache of decoded images
+		// ! a cached texture skips the image decoding, the cache file is keyed by the
+		//   path, size and modification time of the source file
+		// ! textures read from a mounted archive are not cached
+		// @param1: the directory of the cache files, an empty string disables the cache
+		// @param2: to indicate if the pixels are LZ4 compressed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_image_cache(std::string const& directory, bool compress = true) -> void
+		{
+			_image_cache.set_directory(directory, compress);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! enables reloading textures when their loose file changes
+		// ! a changed file is decoded on a worker thread and uploaded into the stored
+		//   sf::Texture at the next call of process(), every shared pointer handed
+		//   out before sees the new pixels
+		// ! a texture deduplicated with a key of another file stays unchanged for
+		//   that key, the reloaded key gets a texture of its own
+		// ! an atlas texture that changed its size is packed anew
+		// ! only textures loaded while it is enabled are watched
+		// ! the file watcher is created the first time it is enabled, a wrapper
+		//   without hot reload holds no watcher
+		// @param1: to indicate if hot reload is enabled
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_hot_reload(bool enabled) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if(enabled && (_watcher == nullptr))
+					_watcher.reset(new nfile_watcher());
+				_hot_reload = enabled;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the memory budget of the sf::Texture resources
+		// ! unused textures are kept until the budget is exceeded and then dropped
+		//   least recently used first
+		// @param1: the budget in bytes, 0 disables it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_texture_budget(std::size_t bytes) -> void
+		{
+			_ntextures.set_budget(bytes);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the cache counters of the sf::Texture resources
+		// @return: hits, misses, evictions, the stored bytes and the budget
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_texture_stats() -> nresource_stats
+		{
+			return _ntextures.get_stats();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
 		// ! loads a sf::Font
+		// ! the glyphs of param3 are rasterized right away, so the first frame that
+		//   draws them does not stall, an already stored font is warmed as well
+		// @param1: the key identifier
+		// @param2: the path to the font to be loaded
+		// @param3: the glyphs to be rasterized, may be empty
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_font(std::string const& key, std::string const& path, nglyph_set const& glyphs = nglyph_set()) -> void
+		{
+			if(!_nfonts.test(key) && !_dedupe(_nfonts, _get_dedup_id("font", path), key))
+			{
+				auto start = std::chrono::steady_clock::now();
+				auto font = _load_font(path);
+				if(font == nullptr)
+				{
+					return;
+				}
+				_nfonts.adopt(key, font);
+				_nfonts.record_load(_get_elapsed(start));
+				_remember(_get_dedup_id("font", path), key);
+			}
+			_warm_font(key, glyphs);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a sf::Font in the background
+		// ! the glyphs of param3 are rasterized by process() on the render thread
+		//   before the future is set
 		// @param1: the key identifier
 		// @param2: the path to the font to be loaded
+		// @param3: the glyphs to be rasterized, may be empty
+		// @return: a future that holds true once the font is stored, without glyphs
+		//          the future of a running load of param1 is shared
 		/////////////////////////////////////////////////////////////////////////////////
-		auto load_font(std::string const& key, std::string const& path) -> void
+		auto load_font_async(std::string const& key, std::string const& path, nglyph_set const& glyphs = nglyph_set()) -> std::shared_future<bool>
 		{
-			sf::Font font;
-			if(font.loadFromFile(path))
+			std::shared_future<bool> future;
+			auto id = "font:" + key;
+			std::shared_ptr<std::promise<bool>> promise;
+			if(glyphs.is_empty()) // a load with glyphs has to warm them itself
+			{
+				promise = _begin_load(id, future);
+				if(promise == nullptr)
+				{
+					return future;
+				}
+			}
+			else
+			{
+				id.clear();
+				promise = std::make_shared<std::promise<bool>>();
+				future = promise->get_future().share();
+			}
+			if(_nfonts.test(key) || _dedupe(_nfonts, _get_dedup_id("font", path), key))
 			{
-				_nfonts.add(key, font);
+				_add_warm_font(key, glyphs, id, promise);
+				return future;
 			}
+			_get_pool().push([this, id, key, path, glyphs, promise]()
+			{
+				auto start = std::chrono::steady_clock::now();
+				auto font = _load_font(path);
+				if(font != nullptr)
+				{
+					_nfonts.adopt(key, font);
+					_nfonts.record_load(_get_elapsed(start));
+					_remember(_get_dedup_id("font", path), key);
+					_add_warm_font(key, glyphs, id, promise);
+				}
+				else
+				{
+					_end_load(id, promise, false);
+				}
+			});
+			return future;
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! to get a sf::Font
@@ -251,53 +999,1107 @@ class nresource_wrapper : public nresource_manager<std::string, VAL>
 			return _nfonts.get(key);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! loads a sf::SoundBuffer
+		// ! interns a sf::Font key so it can be looked up by handle
 		// @param1: the key identifier
-		// @param2: the path to the sound to be loaded
+		// @return: the handle to param1
 		/////////////////////////////////////////////////////////////////////////////////
-		auto load_soundbuffer(std::string const& key, std::string const& path) -> void
+		auto intern_font(std::string const& key) -> nhandle<sf::Font>
 		{
-			sf::SoundBuffer buff;
-			if(buff.loadFromFile(path))
-			{
-				_nsoundbuffers.add(key, buff);
-			}
+			return _nfonts.intern(key);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! to get a sf::SoundSoundBuffer
-		// @param1: the key identifier
-		// @return: the sf::SoundSoundBuffer identified by param1
+		// ! to get a sf::Font by handle
+		// @param1: the handle returned by intern_font()
+		// @return: the sf::Font identified by param1
 		/////////////////////////////////////////////////////////////////////////////////
-		auto get_soundbuffer(std::string const& key) -> sf::SoundBuffer const&
+		auto get_font(nhandle<sf::Font> const& handle) -> sf::Font const&
 		{
-			return *_nsoundbuffers.get(key);
+			return *_nfonts.get(handle);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! to get a sf::SoundSoundBuffer by shared pointer
-		// @param1: the key identifier
-		// @return: the sf::SoundSoundBuffer identified by param1
+		// ! to get a sf::Font by handle as shared pointer
+		// @param1: the handle returned by intern_font()
+		// @return: the sf::Font identified by param1
 		/////////////////////////////////////////////////////////////////////////////////
-		auto get_soundbuffer_p(std::string const& key) -> std::shared_ptr<const sf::SoundBuffer>
+		auto get_font_p(nhandle<sf::Font> const& handle) -> std::shared_ptr<const sf::Font>
 		{
-			return _nsoundbuffers.get(key);
+			return _nfonts.get(handle);
 		}
-	private:
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! one internal nresource_manager wildcard
+		// ! sets the memory budget of the sf::Font resources
+		// ! sfml does not report the glyph memory of a font so only the object
+		//   itself is counted
+		// @param1: the budget in bytes, 0 disables it
 		/////////////////////////////////////////////////////////////////////////////////
-		nresource_manager<std::string, VAL> _nresources;
+		auto set_font_budget(std::size_t bytes) -> void
+		{
+			_nfonts.set_budget(bytes);
+		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! internal sf::Texture nresource_manager
+		// ! to get the cache counters of the sf::Font resources
+		// @return: hits, misses, evictions, the stored bytes and the budget
 		/////////////////////////////////////////////////////////////////////////////////
-		nresource_manager<std::string, sf::Texture> _ntextures;
+		auto get_font_stats() -> nresource_stats
+		{
+			return _nfonts.get_stats();
+		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! internal sf::Font nresource_manager
+		// ! loads a sf::SoundBuffer
+		// @param1: the key identifier
+		// @param2: the path to the sound to be loaded
 		/////////////////////////////////////////////////////////////////////////////////
-		nresource_manager<std::string, sf::Font> _nfonts;
+		auto load_soundbuffer(std::string const& key, std::string const& path) -> void
+		{
+			if(_nsoundbuffers.test(key) || _dedupe(_nsoundbuffers, _get_dedup_id("soundbuffer", path), key))
+			{
+				return;
+			}
+			auto start = std::chrono::steady_clock::now();
+			auto buff = std::make_shared<sf::SoundBuffer>();
+			if(_load_from(*buff, path))
+			{
+				_add_soundbuffer(key, path, buff);
+				_nsoundbuffers.record_load(_get_elapsed(start));
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a sf::SoundBuffer in the background
+		// @param1: the key identifier
+		// @param2: the path to the sound to be loaded
+		// @return: a future that holds true once the sound is stored, the future of
+		//          a running load of param1 is shared
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_soundbuffer_async(std::string const& key, std::string const& path) -> std::shared_future<bool>
+		{
+			std::shared_future<bool> future;
+			auto id = "soundbuffer:" + key;
+			auto promise = _begin_load(id, future);
+			if(promise == nullptr)
+			{
+				return future;
+			}
+			if(_nsoundbuffers.test(key) || _dedupe(_nsoundbuffers, _get_dedup_id("soundbuffer", path), key))
+			{
+				_end_load(id, promise, true);
+				return future;
+			}
+			_get_pool().push([this, id, key, path, promise]()
+			{
+				auto start = std::chrono::steady_clock::now();
+				auto buff = std::make_shared<sf::SoundBuffer>();
+				if(_load_from(*buff, path))
+				{
+					_add_soundbuffer(key, path, buff);
+					_nsoundbuffers.record_load(_get_elapsed(start));
+					_end_load(id, promise, true);
+				}
+				else
+				{
+					_end_load(id, promise, false);
+				}
+			});
+			return future;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get a sf::SoundSoundBuffer
+		// @param1: the key identifier
+		// @return: the sf::SoundSoundBuffer identified by param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_soundbuffer(std::string const& key) -> sf::SoundBuffer const&
+		{
+			return *_nsoundbuffers.get(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get a sf::SoundSoundBuffer by shared pointer
+		// @param1: the key identifier
+		// @return: the sf::SoundSoundBuffer identified by param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_soundbuffer_p(std::string const& key) -> std::shared_ptr<const sf::SoundBuffer>
+		{
+			return _nsoundbuffers.get(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! interns a sf::SoundBuffer key so it can be looked up by handle
+		// @param1: the key identifier
+		// @return: the handle to param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto intern_soundbuffer(std::string const& key) -> nhandle<sf::SoundBuffer>
+		{
+			return _nsoundbuffers.intern(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get a sf::SoundBuffer by handle
+		// @param1: the handle returned by intern_soundbuffer()
+		// @return: the sf::SoundBuffer identified by param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_soundbuffer(nhandle<sf::SoundBuffer> const& handle) -> sf::SoundBuffer const&
+		{
+			return *_nsoundbuffers.get(handle);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get a sf::SoundBuffer by handle as shared pointer
+		// @param1: the handle returned by intern_soundbuffer()
+		// @return: the sf::SoundBuffer identified by param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_soundbuffer_p(nhandle<sf::SoundBuffer> const& handle) -> std::shared_ptr<const sf::SoundBuffer>
+		{
+			return _nsoundbuffers.get(handle);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the memory budget of the sf::SoundBuffer resources
+		// @param1: the budget in bytes, 0 disables it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_soundbuffer_budget(std::size_t bytes) -> void
+		{
+			_nsoundbuffers.set_budget(bytes);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the cache counters of the sf::SoundBuffer resources
+		// @return: hits, misses, evictions, the stored bytes and the budget
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_soundbuffer_stats() -> nresource_stats
+		{
+			return _nsoundbuffers.get_stats();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a streamed music
+		// ! nothing is decoded, only the header is checked, so a long track loads
+		//   as fast as a short one
+		// @param1: the key identifier
+		// @param2: the path to the music to be loaded
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_music(std::string const& key, std::string const& path) -> void
+		{
+			if(_nmusics.test(key) || _dedupe(_nmusics, _get_dedup_id("music", path), key))
+			{
+				return;
+			}
+			auto start = std::chrono::steady_clock::now();
+			auto music = _load_music(path);
+			if(music != nullptr)
+			{
+				_nmusics.adopt(key, music);
+				_nmusics.record_load(_get_elapsed(start));
+				_remember(_get_dedup_id("music", path), key);
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a streamed music in the background
+		// @param1: the key identifier
+		// @param2: the path to the music to be loaded
+		// @return: a future that holds true once the music is stored, the future of
+		//          a running load of param1 is shared
+		/////////////////////////////////////////////////////////////////////////////////
+		auto load_music_async(std::string const& key, std::string const& path) -> std::shared_future<bool>
+		{
+			std::shared_future<bool> future;
+			auto id = "music:" + key;
+			auto promise = _begin_load(id, future);
+			if(promise == nullptr)
+			{
+				return future;
+			}
+			if(_nmusics.test(key) || _dedupe(_nmusics, _get_dedup_id("music", path), key))
+			{
+				_end_load(id, promise, true);
+				return future;
+			}
+			_get_pool().push([this, id, key, path, promise]()
+			{
+				auto start = std::chrono::steady_clock::now();
+				auto music = _load_music(path);
+				if(music != nullptr)
+				{
+					_nmusics.adopt(key, music);
+					_nmusics.record_load(_get_elapsed(start));
+					_remember(_get_dedup_id("music", path), key);
+					_end_load(id, promise, true);
+				}
+				else
+				{
+					_end_load(id, promise, false);
+				}
+			});
+			return future;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! opens a new sf::Music streaming the music identified by param1
+		// ! the sf::Music keeps its source in use until it is destroyed, so the
+		//   source is not cleared while it plays
+		// @param1: the key identifier
+		// @return: the opened sf::Music or nullptr if param1 is not stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto open_music(std::string const& key) -> std::shared_ptr<sf::Music>
+		{
+			return _open_music(_nmusics.get(key));
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! interns a music key so it can be looked up by handle
+		// @param1: the key identifier
+		// @return: the handle to param1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto intern_music(std::string const& key) -> nhandle<nmusic>
+		{
+			return _nmusics.intern(key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! opens a new sf::Music streaming the music identified by handle
+		// @param1: the handle returned by intern_music()
+		// @return: the opened sf::Music or nullptr if param1 is not stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto open_music(nhandle<nmusic> const& handle) -> std::shared_ptr<sf::Music>
+		{
+			return _open_music(_nmusics.get(handle));
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the cache counters of the music resources
+		// @return: hits, misses, evictions, the stored bytes and the budget
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_music_stats() -> nresource_stats
+		{
+			return _nmusics.get_stats();
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! one internal nresource_manager wildcard
+		/////////////////////////////////////////////////////////////////////////////////
+		nresource_manager<std::string, VAL> _nresources;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! internal sf::Texture nresource_manager
+		/////////////////////////////////////////////////////////////////////////////////
+		nresource_manager<std::string, sf::Texture> _ntextures;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! internal sf::Font nresource_manager
+		/////////////////////////////////////////////////////////////////////////////////
+		nresource_manager<std::string, sf::Font> _nfonts;
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! internal sf::SoundBuffer nresource_manager
 		/////////////////////////////////////////////////////////////////////////////////
 		nresource_manager<std::string, sf::SoundBuffer> _nsoundbuffers;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! internal nmusic nresource_manager for streamed music
+		/////////////////////////////////////////////////////////////////////////////////
+		nresource_manager<std::string, nmusic> _nmusics;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! internal ntexture_region nresource_manager for atlas textures
+		/////////////////////////////////////////////////////////////////////////////////
+		nresource_manager<std::string, ntexture_region> _nregions;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the atlas pages of all textures loaded by load_texture_atlas()
+		// ! shared with the deleter of every stored region, which frees its space
+		/////////////////////////////////////////////////////////////////////////////////
+		std::shared_ptr<ntexture_atlas> _atlas;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the on-disk cache of decoded images, disabled until set_image_cache()
+		/////////////////////////////////////////////////////////////////////////////////
+		nimage_cache _image_cache;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the first key every file and content was stored under
+		// ! identifiers are built by _get_dedup_id()
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unordered_map<std::string, std::string> _origins;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the deduplication identifiers every key was remembered under, so they are
+		//   forgotten once the key is erased
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unordered_map<std::string, std::vector<std::string>> _remembered;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! what the deduplication saved so far
+		/////////////////////////////////////////////////////////////////////////////////
+		ndedup_stats _dedup;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! watches the files of the textures loaded while hot reload is enabled,
+		//   nullptr until it is enabled the first time
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unique_ptr<nfile_watcher> _watcher;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the texture keys of every watched file by resolved path
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unordered_map<std::string, std::vector<std::string>> _reloads;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! indicator if changed files are reloaded
+		/////////////////////////////////////////////////////////////////////////////////
+		bool _hot_reload;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! called with a snapshot every _dump_interval milliseconds
+		/////////////////////////////////////////////////////////////////////////////////
+		std::function<void(nresource_snapshot const&)> _dump;
+		unsigned int _dump_interval;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the time of the last dump
+		/////////////////////////////////////////////////////////////////////////////////
+		std::chrono::steady_clock::time_point _dumped;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety of the running loads, pending uploads, archives,
+		//   preloads, the deduplication, the hot reload and the stats dump
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the futures of the running asynchronous loads by kind and key
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unordered_map<std::string, std::shared_future<bool>> _loading;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! texture uploads waiting for the next call of process()
+		/////////////////////////////////////////////////////////////////////////////////
+		std::queue<nupload> _uploads;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the running preloads, polled by process()
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<npreload> _preloads;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the mounted archives, searched in the order they were mounted
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::shared_ptr<narchive>> _archives;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! makes sure the worker threads are only started once
+		/////////////////////////////////////////////////////////////////////////////////
+		std::once_flag _pool_flag;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the worker threads used for background loading
+		// ! declared last so the workers are joined before anything else is destroyed
+		/////////////////////////////////////////////////////////////////////////////////
+		std::unique_ptr<nthread_pool> _pool;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the worker threads, they are started at the first use
+		// @return: the nthread_pool by reference
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_pool() -> nthread_pool&
+		{
+			std::call_once(_pool_flag, [this]()
+			{
+				unsigned int threads = std::thread::hardware_concurrency();
+				_pool.reset(new nthread_pool((threads > 1) ? (threads - 1) : 1));
+			});
+			return *_pool;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! looks up a path in the mounted archives
+		// @param1: the path to look up
+		// @param2: buffer used for compressed entries
+		// @param3: filled with the pointer to the data
+		// @param4: filled with the size of the data
+		// @return: the archive that contains the path or nullptr, a resource reading
+		//          from the mapped data has to hold it
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _read_archive(std::string const& path, std::vector<char>& buffer, const char*& data, std::size_t& size) -> std::shared_ptr<narchive>
+		{
+			std::vector<std::shared_ptr<narchive>> archives;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				archives = _archives;
+			} // lock freed
+			lock.unlock();
+			for(auto it = archives.begin(); it != archives.end(); it++)
+			{
+				if((*it)->read(path, buffer, data, size))
+				{
+					return *it;
+				}
+			}
+			return nullptr;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a SFML resource from the mounted archives or the loose file
+		// ! uncompressed archive entries are decoded straight from the mapped file
+		// @param1: the SFML resource to load into
+		// @param2: the path to the resource
+		// @return: indicator if the resource could be loaded
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename RESOURCE>
+		auto _load_from(RESOURCE& resource, std::string const& path) -> bool
+		{
+			std::vector<char> buffer;
+			const char* data = nullptr;
+			std::size_t size = 0;
+			if(_read_archive(path, buffer, data, size))
+			{
+				return resource.loadFromMemory(data, size);
+			}
+			return resource.loadFromFile(path);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! decodes an image from the mounted archives, the image cache or the loose
+		//   file, a decoded loose file is written to the image cache
+		// @param1: the image to decode into
+		// @param2: the path to the image
+		// @return: indicator if the image could be decoded
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _load_image(sf::Image& img, std::string const& path) -> bool
+		{
+			std::vector<char> buffer;
+			const char* data = nullptr;
+			std::size_t size = 0;
+			if(_read_archive(path, buffer, data, size))
+			{
+				return img.loadFromMemory(data, size);
+			}
+			if(!_image_cache.is_enabled())
+			{
+				return img.loadFromFile(path);
+			}
+			if(_image_cache.read(path, img))
+			{
+				return true;
+			}
+			if(!img.loadFromFile(path))
+			{
+				return false;
+			}
+			_image_cache.write(path, img);
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! loads a sf::Font from the mounted archives or the loose file
+		// ! the archive of a mapped font file or a decompressed font file is owned by
+		//   the deleter of the returned pointer, so it lives exactly as long as the
+		//   sf::Font reading from it
+		// @param1: the path to the font
+		// @return: the loaded sf::Font or nullptr if it could not be loaded
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _load_font(std::string const& path) -> std::shared_ptr<sf::Font>
+		{
+			std::vector<char> buffer;
+			const char* data = nullptr;
+			std::size_t size = 0;
+			std::shared_ptr<sf::Font> font;
+			auto archive = _read_archive(path, buffer, data, size);
+			if(archive == nullptr)
+			{
+				font = std::make_shared<sf::Font>();
+				return font->loadFromFile(path) ? font : nullptr;
+			}
+			if(buffer.empty() || (data != buffer.data()))
+			{
+				font.reset(new sf::Font(), [archive](sf::Font* ptr) mutable {delete ptr; archive.reset();});
+				return font->loadFromMemory(data, size) ? font : nullptr;
+			}
+			auto memory = std::make_shared<std::vector<char>>(std::move(buffer));
+			font.reset(new sf::Font(), [memory](sf::Font* ptr) mutable {delete ptr; memory.reset();});
+			return font->loadFromMemory(memory->data(), memory->size()) ? font : nullptr;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! prepares a streamed music from the mounted archives or the loose file
+		// ! a mapped archive entry is streamed in place and the nmusic holds its
+		//   archive, a decompressed one is owned by the nmusic
+		// @param1: the path to the music
+		// @return: the nmusic or nullptr if it could not be opened
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _load_music(std::string const& path) -> std::shared_ptr<nmusic>
+		{
+			std::vector<char> buffer;
+			const char* data = nullptr;
+			std::size_t size = 0;
+			auto music = std::make_shared<nmusic>();
+			auto archive = _read_archive(path, buffer, data, size);
+			if(archive == nullptr)
+			{
+				return music->load_from_file(path) ? music : nullptr;
+			}
+			if(buffer.empty() || (data != buffer.data()))
+			{
+				return music->load_from_memory(data, size, archive) ? music : nullptr;
+			}
+			return music->load_from_memory(std::move(buffer)) ? music : nullptr;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! opens a new sf::Music on a nmusic
+		// ! the deleter of the returned pointer holds param1, so the source stays in
+		//   use as long as the sf::Music streams from it
+		// @param1: the nmusic
+		// @return: the opened sf::Music or nullptr if param1 could not be opened
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _open_music(std::shared_ptr<const nmusic> source) -> std::shared_ptr<sf::Music>
+		{
+			std::shared_ptr<sf::Music> music(new sf::Music(), [source](sf::Music* ptr) mutable {delete ptr; source.reset();});
+			return source->open(*music) ? music : nullptr;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! uploads a decoded image as sf::Texture unless the same pixels are stored
+		//   already, has to run on the render thread
+		// @param1: the key identifier
+		// @param2: the path the image was loaded from
+		// @param3: the decoded image
+		// @param4: the content hash of param3, see _hash_image()
+		// @return: indicator if the texture is stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _add_texture(std::string const& key, std::string const& path, sf::Image const& img, std::uint64_t hash) -> bool
+		{
+			auto content = _get_dedup_id("texture", hash);
+			if(!_dedupe(_ntextures, content, key))
+			{
+				auto tex = std::make_shared<sf::Texture>();
+				if(!tex->loadFromImage(img))
+				{
+					return false;
+				}
+				_ntextures.adopt(key, tex);
+				_remember(content, key);
+			}
+			_remember(_get_dedup_id("texture", path), key);
+			_watch(path, key);
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! packs a decoded image onto the texture atlas unless the same pixels are
+		//   stored already, an image larger than a page is stored as a standalone
+		//   texture, has to run on the render thread
+		// @param1: the key identifier
+		// @param2: the path the image was loaded from
+		// @param3: the decoded image
+		// @param4: the content hash of param3, see _hash_image()
+		// @return: indicator if the texture is stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _add_texture_atlas(std::string const& key, std::string const& path, sf::Image const& img, std::uint64_t hash) -> bool
+		{
+			auto content = _get_dedup_id("atlas", hash);
+			if(!_dedupe_atlas(content, key))
+			{
+				auto region = _add_region(img);
+				if(region != nullptr)
+				{
+					_nregions.adopt(key, std::move(region));
+				}
+				else
+				{
+					auto tex = std::make_shared<sf::Texture>();
+					if(!tex->loadFromImage(img))
+					{
+						return false;
+					}
+					_ntextures.adopt(key, tex);
+				}
+				_remember(content, key);
+			}
+			_remember(_get_dedup_id("atlas", path), key);
+			_watch(path, key);
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! packs a decoded image onto the texture atlas, the space is freed once the
+		//   last holder of the returned region drops it
+		// @param1: the decoded image
+		// @return: the packed region or nullptr if param1 is larger than a page
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _add_region(sf::Image const& img) -> std::shared_ptr<ntexture_region>
+		{
+			ntexture_region region;
+			if(!_atlas->add(img, region))
+			{
+				return nullptr;
+			}
+			std::weak_ptr<ntexture_atlas> atlas = _atlas;
+			return std::shared_ptr<ntexture_region>(new ntexture_region(std::move(region)), [atlas](ntexture_region* ptr)
+			{
+				auto owner = atlas.lock();
+				if(owner != nullptr)
+					owner->remove(*ptr);
+				delete ptr;
+			});
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! stores a loaded sf::SoundBuffer unless the same samples are stored already
+		// @param1: the key identifier
+		// @param2: the path the sound was loaded from
+		// @param3: the loaded sf::SoundBuffer
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _add_soundbuffer(std::string const& key, std::string const& path, std::shared_ptr<sf::SoundBuffer> buff) -> void
+		{
+			auto content = _get_dedup_id("soundbuffer", nhash(buff->getSamples(), static_cast<std::size_t>(buff->getSampleCount()) * sizeof(sf::Int16)));
+			if(!_dedupe(_nsoundbuffers, content, key))
+			{
+				_nsoundbuffers.adopt(key, std::move(buff));
+				_remember(content, key);
+			}
+			_remember(_get_dedup_id("soundbuffer", path), key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the deduplication identifier of a file
+		// ! the path is resolved, so different spellings of one file are equal
+		// @param1: the kind of resource
+		// @param2: the path to the file
+		// @return: the identifier
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_dedup_id(std::string const& kind, std::string const& path) -> std::string
+		{
+			return kind + ":" + _get_canonical(path);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the resolved absolute path of a file
+		// @param1: the path to the file
+		// @return: the resolved path or param1 if it is not a loose file, e.g. an
+		//          archive entry
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_canonical(std::string const& path) -> std::string
+		{
+#ifdef _WIN32
+			char resolved[_MAX_PATH];
+			if(_fullpath(resolved, path.c_str(), _MAX_PATH) != nullptr)
+#else
+			char resolved[PATH_MAX];
+			if(realpath(path.c_str(), resolved) != nullptr)
+#endif
+			{
+				return resolved;
+			}
+			return path;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the deduplication identifier of a content hash
+		// @param1: the kind of resource
+		// @param2: the content hash
+		// @return: the identifier
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_dedup_id(std::string const& kind, std::uint64_t hash) -> std::string
+		{
+			return kind + "#" + std::to_string(hash);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the content hash of a decoded image, the size is part of it
+		// @param1: the decoded image
+		// @return: the hash
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _hash_image(sf::Image const& img) -> std::uint64_t
+		{
+			sf::Vector2u size = img.getSize();
+			std::uint64_t hash = nhash(&size.x, sizeof(size.x));
+			hash = nhash(&size.y, sizeof(size.y), hash);
+			return nhash(img.getPixelsPtr(), static_cast<std::size_t>(size.x) * size.y * 4, hash);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! stores param3 as alias of the first key stored under param2
+		// @param1: the nresource_manager of the resource kind
+		// @param2: the deduplication identifier
+		// @param3: the key identifier
+		// @return: indicator if param3 is stored now
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename RESOURCE>
+		auto _dedupe(nresource_manager<std::string, RESOURCE>& nres, std::string const& id, std::string const& key) -> bool
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				auto it = _origins.find(id);
+				if((it == _origins.end()) || (it->second == key))
+				{
+					return false;
+				}
+				auto val = nres.alias(key, it->second);
+				if(val == nullptr) // the first key was cleared meanwhile
+				{
+					return false;
+				}
+				_dedup._aliases++;
+				_dedup._bytes_saved += _get_dedup_bytes(*val);
+				return true;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! stores param2 as alias of the first atlas region or standalone texture
+		//   stored under param1
+		// @param1: the deduplication identifier
+		// @param2: the key identifier
+		// @return: indicator if param2 is stored now
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _dedupe_atlas(std::string const& id, std::string const& key) -> bool
+		{
+			return (_dedupe(_nregions, id, key) || _dedupe(_ntextures, id, key));
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! remembers param2 as the first key of param1
+		// @param1: the deduplication identifier
+		// @param2: the key identifier
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _remember(std::string const& id, std::string const& key) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				auto& origin = _origins[id];
+				if(origin == key)
+					return;
+				origin = key;
+				_remembered[key].push_back(id);
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! forgets the deduplication identifiers of a key, called by the
+		//   nresource_manager of the key for every erased value
+		// @param1: the key identifier
+		// @param2: the beginnings of the identifiers to forget, e.g. "texture#" for
+		//          the content of a texture
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _forget(std::string const& key, std::vector<std::string> const& prefixes) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				auto it = _remembered.find(key);
+				if(it == _remembered.end())
+					return;
+				auto& ids = it->second;
+				for(std::size_t i = 0; i < ids.size();)
+				{
+					bool match = false;
+					for(auto& prefix : prefixes)
+						match = match || (ids[i].compare(0, prefix.size(), prefix) == 0);
+					if(!match)
+					{
+						i++;
+						continue;
+					}
+					auto origin = _origins.find(ids[i]);
+					if((origin != _origins.end()) && (origin->second == key))
+						_origins.erase(origin);
+					ids[i] = ids.back();
+					ids.pop_back();
+				}
+				if(ids.empty())
+					_remembered.erase(it);
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the memory a deduplicated resource would have occupied
+		// @param1: the resource
+		// @return: the amount of bytes
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename RESOURCE>
+		auto _get_dedup_bytes(RESOURCE const& resource) -> std::size_t
+		{
+			return nresource_size<RESOURCE>::get(resource);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! an atlas region occupies its rect on the atlas page
+		// @param1: the atlas region
+		// @return: the amount of bytes
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_dedup_bytes(ntexture_region const& region) -> std::size_t
+		{
+			return (static_cast<std::size_t>(region._rect.width) * region._rect.height * 4);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! reports the progress of the running preloads and completes the finished
+		//   ones, called by process()
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _poll_preloads() -> void
+		{
+			std::vector<npreload> preloads;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				std::swap(preloads, _preloads);
+			} // lock freed
+			lock.unlock();
+			for(auto it = preloads.begin(); it != preloads.end();)
+			{
+				unsigned int done = it->_total - it->_futures.size();
+				bool result = true;
+				for(auto& future : it->_futures)
+				{
+					if(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+					{
+						done++;
+						result = result && future.get();
+					}
+				}
+				if((done != it->_done) && it->_progress)
+					it->_progress(done, it->_total);
+				it->_done = done;
+				if(done == it->_total)
+				{
+					it->_promise->set_value(result);
+					it = preloads.erase(it);
+				}
+				else
+				{
+					it++;
+				}
+			}
+			lock.lock();
+			{ // locked area
+				_preloads.insert(_preloads.end(), preloads.begin(), preloads.end());
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! watches the loose file of a texture if hot reload is enabled
+		// @param1: the path to the texture
+		// @param2: the key identifier
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _watch(std::string const& path, std::string const& key) -> void
+		{
+			auto canonical = _get_canonical(path);
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if(!_hot_reload)
+					return;
+				auto& keys = _reloads[canonical];
+				if(std::find(keys.begin(), keys.end(), key) == keys.end())
+					keys.push_back(key);
+				_watcher->watch(canonical);
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! decodes every changed watched file on a worker thread and queues the
+		//   upload into its textures, called by process()
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _poll_reloads() -> void
+		{
+			std::vector<std::string> changed;
+			std::vector<std::vector<std::string>> keys;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if(!_hot_reload)
+					return;
+				_watcher->poll(changed);
+				for(auto it = changed.begin(); it != changed.end(); it++)
+					keys.push_back(_reloads[*it]);
+			} // lock freed
+			lock.unlock();
+			for(std::size_t i = 0; i < changed.size(); i++)
+			{
+				auto path = changed[i];
+				auto reload = keys[i];
+				_get_pool().push([this, path, reload]()
+				{
+					auto img = std::make_shared<sf::Image>();
+					if(!img->loadFromFile(path)) // e.g. still being written
+						return;
+					if(_image_cache.is_enabled())
+						_image_cache.write(path, *img);
+					auto hash = _hash_image(*img);
+					_add_upload([this, reload, img, hash]()
+					{
+						_reload_textures(reload, *img, hash);
+					});
+				});
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! uploads new pixels into the textures of a changed file, has to run on the
+		//   render thread
+		// ! keys of the file that share one texture are reloaded together, so the
+		//   texture is updated in place once unless a key of another file shares it
+		// @param1: the key identifiers watching the file
+		// @param2: the decoded image
+		// @param3: the content hash of param2, see _hash_image()
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _reload_textures(std::vector<std::string> const& keys, sf::Image const& img, std::uint64_t hash) -> void
+		{
+			std::vector<const void*> values;
+			for(auto it = keys.begin(); it != keys.end(); it++)
+				values.push_back(_get_texture_value(*it));
+			for(std::size_t i = 0; i < keys.size(); i++)
+			{
+				if(values[i] == nullptr)
+					continue;
+				auto value = values[i];
+				std::size_t sharing = std::count(values.begin() + i, values.end(), value);
+				_reload_texture(keys[i], img, hash, sharing);
+				if(_get_texture_value(keys[i]) != value) // reloaded into a texture of its own
+					continue;
+				for(std::size_t j = i + 1; j < keys.size(); j++) // updated in place for all of them
+				{
+					if(values[j] == value)
+						values[j] = nullptr;
+				}
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the stored atlas region or standalone texture of a key
+		// @param1: the key identifier
+		// @return: the address of the value or nullptr if param1 is not stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_texture_value(std::string const& key) -> const void*
+		{
+			if(_nregions.test(key))
+				return _nregions.get(key).get();
+			if(_ntextures.test(key))
+				return _ntextures.get(key).get();
+			return nullptr;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! uploads new pixels into a stored texture, has to run on the render thread
+		// ! a texture no other keys than the param4 ones share is updated in place,
+		//   otherwise it stays theirs and the key gets a texture of its own
+		// ! an atlas texture that changed its size is packed anew
+		// ! the key is remembered under its new content instead of the old one
+		// @param1: the key identifier
+		// @param2: the decoded image
+		// @param3: the content hash of param2, see _hash_image()
+		// @param4: the amount of keys of the changed file sharing the texture
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _reload_texture(std::string const& key, sf::Image const& img, std::uint64_t hash, std::size_t sharing) -> void
+		{
+			std::string kind = "atlas";
+			bool reloaded = _nregions.update_own(key, [this, &img](ntexture_region& region) -> bool
+			{
+				return _atlas->update(region, img);
+			}, [this, &img]()
+			{
+				return _add_region(img);
+			}, sharing);
+			if(!reloaded && !_nregions.test(key))
+			{
+				kind = "texture";
+				reloaded = _ntextures.update_own(key, [&img](sf::Texture& tex) -> bool
+				{
+					if(tex.getSize() == img.getSize())
+					{
+						tex.update(img);
+						return true;
+					}
+					return tex.loadFromImage(img);
+				}, [&img]() -> std::shared_ptr<sf::Texture>
+				{
+					auto tex = std::make_shared<sf::Texture>();
+					if(!tex->loadFromImage(img))
+						return nullptr;
+					return tex;
+				}, sharing);
+			}
+			if(!reloaded)
+			{
+				return;
+			}
+			_forget(key, {"texture#", "atlas#"});
+			_remember(_get_dedup_id(kind, hash), key);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the time passed since param1
+		// @param1: the start time
+		// @return: the elapsed time
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_elapsed(std::chrono::steady_clock::time_point start) -> std::chrono::nanoseconds
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! calls the stats dump if its interval passed, called by process()
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _poll_dump() -> void
+		{
+			std::function<void(nresource_snapshot const&)> dump;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				auto now = std::chrono::steady_clock::now();
+				if((_dump_interval == 0) || !_dump || (now - _dumped < std::chrono::milliseconds(_dump_interval)))
+					return;
+				_dumped = now;
+				dump = _dump;
+			} // lock freed
+			lock.unlock();
+			dump(get_snapshot());
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! writes the counters of one resource kind
+		// @param1: the stream to write to
+		// @param2: the name of the resource kind
+		// @param3: the counters
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _dump_stats(std::ostream& stream, const char* name, nresource_stats const& stats) -> void
+		{
+			unsigned long long timed = 0;
+			for(unsigned int i = 0; i < NRESOURCE_LOAD_BUCKETS; i++)
+				timed += stats._load_histogram[i];
+			stream << std::fixed << std::setprecision(2) << name
+				<< ": " << (stats._bytes / 1024) << " KiB resident"
+				<< ", hits " << stats._hits << ", misses " << stats._misses
+				<< ", loads " << stats._loads
+				<< " (avg " << ((timed > 0) ? stats._load_time / timed / 1e6 : 0.0) << " ms, max " << (stats._load_time_max / 1e6) << " ms)"
+				<< ", evictions " << stats._evictions
+				<< ", lock waits " << stats._lock_waits << " (" << (stats._lock_wait_time / 1e6) << " ms)"
+				<< ", load ms histogram";
+			for(unsigned int i = 0; i < NRESOURCE_LOAD_BUCKETS; i++)
+				stream << ' ' << stats._load_histogram[i];
+			stream << std::endl;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! rasterizes the glyphs of a stored sf::Font
+		// ! the glyph pages are textures, so it has to run on the render thread
+		// @param1: the key identifier
+		// @param2: the glyphs to be rasterized, may be empty
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _warm_font(std::string const& key, nglyph_set const& glyphs) -> void
+		{
+			if(glyphs.is_empty())
+			{
+				return;
+			}
+			auto font = _nfonts.get(key);
+			if(font != nullptr)
+			{
+				glyphs.warm(*font);
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! queues the warming of a stored sf::Font for the next process() and sets
+		//   the promise afterwards, without glyphs the promise is set right away
+		// @param1: the key identifier
+		// @param2: the glyphs to be rasterized, may be empty
+		// @param3: the in-flight identifier of the asynchronous load, may be empty
+		// @param4: the promise of the asynchronous load
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _add_warm_font(std::string const& key, nglyph_set const& glyphs, std::string const& id, std::shared_ptr<std::promise<bool>> promise) -> void
+		{
+			if(glyphs.is_empty())
+			{
+				_end_load(id, promise, true);
+				return;
+			}
+			_add_upload([this, key, glyphs, id, promise]()
+			{
+				_warm_font(key, glyphs);
+				_end_load(id, promise, true);
+			}, promise);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! queues a texture upload for the next call of process()
+		// @param1: the upload to run on the render thread
+		// @param2: the promise the upload sets, failed if the wrapper is destroyed
+		//          before the upload ran, may be empty
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _add_upload(std::function<void()> upload, std::shared_ptr<std::promise<bool>> promise = nullptr) -> void
+		{
+			nupload entry;
+			entry._upload = std::move(upload);
+			entry._promise = std::move(promise);
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_uploads.push(std::move(entry));
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the future of a running asynchronous load or to start a new one
+		// @param1: the in-flight identifier, the kind and the key
+		// @param2: filled with the future of the load
+		// @return: the promise of the new load or nullptr if param1 is loading already
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _begin_load(std::string const& id, std::shared_future<bool>& future) -> std::shared_ptr<std::promise<bool>>
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				auto it = _loading.find(id);
+				if(it != _loading.end())
+				{
+					future = it->second;
+					return nullptr;
+				}
+				auto promise = std::make_shared<std::promise<bool>>();
+				future = promise->get_future().share();
+				_loading.emplace(id, future);
+				return promise;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! completes an asynchronous load, the next load of its key starts anew
+		// @param1: the in-flight identifier, may be empty
+		// @param2: the promise of the load
+		// @param3: indicator if the resource is stored
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _end_load(std::string const& id, std::shared_ptr<std::promise<bool>> const& promise, bool result) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_loading.erase(id);
+			} // lock freed
+			lock.unlock();
+			promise->set_value(result);
+		}
 }; // end of class nresource_wrapper
 
 } // end of namespace nresource_manager
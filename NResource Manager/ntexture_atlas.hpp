@@ -0,0 +1,398 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__TEXTURE_ATLAS__
+#define __NENGINE__NRESOURCE_MANAGER__TEXTURE_ATLAS__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! memory for shared pointers
+// ! mutex for thread safety
+// ! vector for pages and skylines
+// ! SFML/Graphics.hpp for sfml structures
+/////////////////////////////////////////////////////////////////////////////////
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a part of a texture, e.g. a packed texture on an atlas page
+/////////////////////////////////////////////////////////////////////////////////
+struct ntexture_region
+{
+	std::shared_ptr<const sf::Texture> _texture;
+	sf::IntRect _rect;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the packing statistics of a ntexture_atlas
+/////////////////////////////////////////////////////////////////////////////////
+struct natlas_stats
+{
+	unsigned int _pages;
+	unsigned int _textures;
+	float _efficiency;
+	unsigned int _max_saved_switches;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! packs small images into shared texture pages with a skyline packer
+// ! the space of a removed image is reused by the next image it fits, a page
+//   without images is dropped
+// ! pages are sf::Textures, so add() has to be called on the render thread
+/////////////////////////////////////////////////////////////////////////////////
+class ntexture_atlas
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		ntexture_atlas(const ntexture_atlas&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		ntexture_atlas& operator=(const ntexture_atlas&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		// @param1: the width and height of every page
+		// @param2: the empty pixels kept around every image to avoid bleeding
+		/////////////////////////////////////////////////////////////////////////////////
+		ntexture_atlas(unsigned int page_size = 1024, unsigned int padding = 1)
+			: _mutex()
+			, _page_size(page_size)
+			, _padding(padding)
+			, _pages()
+			, _textures(0)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! packs an image into the first page it fits on, a new page is created if
+		//   it fits nowhere
+		// @param1: the image to pack
+		// @param2: filled with the page and the sub-rect of the packed image
+		// @return: indicator if the image was packed, false if it is larger than a page
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add(sf::Image const& image, ntexture_region& region) -> bool
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				unsigned int width = image.getSize().x + _padding;
+				unsigned int height = image.getSize().y + _padding;
+				if((image.getSize().x == 0) || (image.getSize().y == 0) || (width > _page_size) || (height > _page_size))
+					return false;
+				for(auto it = _pages.begin(); it != _pages.end(); it++)
+				{
+					if(_reuse(*it, image, width, height, region))
+						return true;
+				}
+				for(auto it = _pages.begin(); it != _pages.end(); it++)
+				{
+					if(_insert(*it, image, width, height, region))
+						return true;
+				}
+				npage page;
+				page._texture = std::make_shared<sf::Texture>();
+				if(!page._texture->create(_page_size, _page_size))
+					return false;
+				_clear(page, sf::IntRect(0, 0, _page_size, _page_size)); // the content of a new texture is undefined
+				page._skyline.push_back(nskyline_node{0, 0, _page_size});
+				page._used = 0;
+				page._regions = 0;
+				_pages.push_back(page);
+				return _insert(_pages.back(), image, width, height, region);
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! replaces the pixels of a packed image in place, the region keeps its rect
+		// @param1: the region returned by add()
+		// @param2: the new image, it has to be as large as the rect of param1
+		// @return: indicator if the pixels were replaced
+		/////////////////////////////////////////////////////////////////////////////////
+		auto update(ntexture_region const& region, sf::Image const& image) -> bool
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if((static_cast<int>(image.getSize().x) != region._rect.width) || (static_cast<int>(image.getSize().y) != region._rect.height))
+					return false;
+				for(auto it = _pages.begin(); it != _pages.end(); it++)
+				{
+					if(it->_texture == region._texture)
+					{
+						it->_texture->update(image, region._rect.left, region._rect.top);
+						return true;
+					}
+				}
+				return false;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! frees the space of a packed image, it is reused by the next image that
+		//   fits into it and cleared then, so it can be called from any thread
+		// ! a page that holds no image anymore is dropped
+		// @param1: the region returned by add()
+		// @return: indicator if param1 was packed on a page of this atlas
+		/////////////////////////////////////////////////////////////////////////////////
+		auto remove(ntexture_region const& region) -> bool
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				for(auto it = _pages.begin(); it != _pages.end(); it++)
+				{
+					if(it->_texture != region._texture)
+						continue;
+					it->_used -= static_cast<unsigned long long>(region._rect.width) * region._rect.height;
+					it->_regions--;
+					_textures--;
+					if(it->_regions == 0)
+						_pages.erase(it);
+					else
+						it->_free.push_back(sf::IntRect(region._rect.left, region._rect.top, region._rect.width + _padding, region._rect.height + _padding));
+					return true;
+				}
+				return false;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the packing statistics
+		// ! max saved switches is the upper bound of texture binds saved per frame,
+		//   it is reached if every packed texture is drawn once and the draws are
+		//   sorted by page
+		// @return: the packing statistics
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_stats() -> natlas_stats
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				natlas_stats stats;
+				stats._pages = _pages.size();
+				stats._textures = _textures;
+				unsigned long long used = 0;
+				for(auto it = _pages.begin(); it != _pages.end(); it++)
+					used += it->_used;
+				unsigned long long area = static_cast<unsigned long long>(_page_size) * _page_size * _pages.size();
+				stats._efficiency = (area > 0) ? static_cast<float>(used) / area : 0.0f;
+				stats._max_saved_switches = (_textures > _pages.size()) ? (_textures - _pages.size()) : 0;
+				return stats;
+			} // lock freed
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! a segment of the skyline: the lowest free y for a range of x
+		/////////////////////////////////////////////////////////////////////////////////
+		struct nskyline_node
+		{
+			unsigned int _x;
+			unsigned int _y;
+			unsigned int _width;
+		};
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! a single atlas page
+		/////////////////////////////////////////////////////////////////////////////////
+		struct npage
+		{
+			std::shared_ptr<sf::Texture> _texture;
+			std::vector<nskyline_node> _skyline;
+			std::vector<sf::IntRect> _free;
+			unsigned long long _used;
+			unsigned int _regions;
+		};
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the width and height of every page
+		/////////////////////////////////////////////////////////////////////////////////
+		unsigned int _page_size;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the empty pixels kept around every image
+		/////////////////////////////////////////////////////////////////////////////////
+		unsigned int _padding;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! all pages
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<npage> _pages;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the amount of packed images
+		/////////////////////////////////////////////////////////////////////////////////
+		unsigned int _textures;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! checks where a rectangle fits on the skyline starting at a node
+		// @param1: the page
+		// @param2: the index of the first skyline node
+		// @param3: the width of the rectangle
+		// @param4: the height of the rectangle
+		// @param5: filled with the y coordinate the rectangle would be placed at
+		// @return: indicator if the rectangle fits
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _fit(npage const& page, std::size_t index, unsigned int width, unsigned int height, unsigned int& y) -> bool
+		{
+			if(page._skyline[index]._x + width > _page_size)
+				return false;
+			y = 0;
+			unsigned int width_left = width;
+			for(std::size_t i = index; width_left > 0; i++)
+			{
+				if(i >= page._skyline.size())
+					return false;
+				if(page._skyline[i]._y > y)
+					y = page._skyline[i]._y;
+				if(y + height > _page_size)
+					return false;
+				width_left -= (page._skyline[i]._width < width_left) ? page._skyline[i]._width : width_left;
+			}
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! places an image at the lowest position of a page, ties are broken by the
+		//   narrowest skyline node
+		// @return: indicator if the image fits on the page
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _insert(npage& page, sf::Image const& image, unsigned int width, unsigned int height, ntexture_region& region) -> bool
+		{
+			std::size_t best = page._skyline.size();
+			unsigned int best_bottom = 0;
+			unsigned int best_width = 0;
+			unsigned int best_y = 0;
+			for(std::size_t i = 0; i < page._skyline.size(); i++)
+			{
+				unsigned int y = 0;
+				if(!_fit(page, i, width, height, y))
+					continue;
+				if((best == page._skyline.size()) || (y + height < best_bottom)
+					|| ((y + height == best_bottom) && (page._skyline[i]._width < best_width)))
+				{
+					best = i;
+					best_bottom = y + height;
+					best_width = page._skyline[i]._width;
+					best_y = y;
+				}
+			}
+			if(best == page._skyline.size())
+				return false;
+
+			unsigned int x = page._skyline[best]._x;
+			page._skyline.insert(page._skyline.begin() + best, nskyline_node{x, best_y + height, width});
+			// cut the nodes now covered by the new one
+			for(std::size_t i = best + 1; i < page._skyline.size();)
+			{
+				nskyline_node& prev = page._skyline[i - 1];
+				nskyline_node& node = page._skyline[i];
+				if(node._x >= prev._x + prev._width)
+					break;
+				unsigned int shrink = prev._x + prev._width - node._x;
+				if(node._width <= shrink)
+				{
+					page._skyline.erase(page._skyline.begin() + i);
+					continue;
+				}
+				node._x += shrink;
+				node._width -= shrink;
+				break;
+			}
+			// merge neighbours of the same height
+			for(std::size_t i = 0; i + 1 < page._skyline.size();)
+			{
+				if(page._skyline[i]._y == page._skyline[i + 1]._y)
+				{
+					page._skyline[i]._width += page._skyline[i + 1]._width;
+					page._skyline.erase(page._skyline.begin() + i + 1);
+				}
+				else
+				{
+					i++;
+				}
+			}
+
+			_place(page, image, x, best_y, region);
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! places an image into the smallest freed space of a page it fits, the rest
+		//   of the space stays free
+		// @return: indicator if the image fits into a freed space
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _reuse(npage& page, sf::Image const& image, unsigned int width, unsigned int height, ntexture_region& region) -> bool
+		{
+			std::size_t best = page._free.size();
+			for(std::size_t i = 0; i < page._free.size(); i++)
+			{
+				sf::IntRect const& space = page._free[i];
+				if((static_cast<unsigned int>(space.width) < width) || (static_cast<unsigned int>(space.height) < height))
+					continue;
+				if((best == page._free.size()) || (space.width * space.height < page._free[best].width * page._free[best].height))
+					best = i;
+			}
+			if(best == page._free.size())
+				return false;
+
+			sf::IntRect space = page._free[best];
+			page._free.erase(page._free.begin() + best);
+			if(static_cast<unsigned int>(space.width) > width)
+				page._free.push_back(sf::IntRect(space.left + width, space.top, space.width - width, height));
+			if(static_cast<unsigned int>(space.height) > height)
+				page._free.push_back(sf::IntRect(space.left, space.top + height, space.width, space.height - height));
+			_clear(page, sf::IntRect(space.left, space.top, width, height)); // the padding must not show the removed image
+			_place(page, image, space.left, space.top, region);
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! uploads an image onto a page and fills its region
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _place(npage& page, sf::Image const& image, unsigned int x, unsigned int y, ntexture_region& region) -> void
+		{
+			page._texture->update(image, x, y);
+			page._used += static_cast<unsigned long long>(image.getSize().x) * image.getSize().y;
+			page._regions++;
+			_textures++;
+			region._texture = page._texture;
+			region._rect = sf::IntRect(x, y, image.getSize().x, image.getSize().y);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! makes a part of a page transparent
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _clear(npage& page, sf::IntRect const& rect) -> void
+		{
+			sf::Image clear;
+			clear.create(rect.width, rect.height, sf::Color::Transparent);
+			page._texture->update(clear, rect.left, rect.top);
+		}
+}; // end of class ntexture_atlas
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__TEXTURE_ATLAS__
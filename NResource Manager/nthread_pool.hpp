@@ -0,0 +1,168 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRESOURCE_MANAGER__THREAD_POOL__
+#define __NENGINE__NRESOURCE_MANAGER__THREAD_POOL__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! condition_variable for waking up idle workers
+// ! functional for the queued tasks
+// ! mutex for thread safety
+// ! queue as task storage
+// ! thread for the workers
+// ! vector as worker storage
+/////////////////////////////////////////////////////////////////////////////////
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nresource_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nresource_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a fixed size pool of worker threads for background loading
+/////////////////////////////////////////////////////////////////////////////////
+class nthread_pool
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nthread_pool(const nthread_pool&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nthread_pool& operator=(const nthread_pool&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: starts the worker threads
+		// @param1: the amount of worker threads, at least one is started
+		/////////////////////////////////////////////////////////////////////////////////
+		nthread_pool(unsigned int threads)
+			: _mutex()
+			, _condition()
+			, _tasks()
+			, _workers()
+			, _stop(false)
+		{
+			if(threads == 0)
+				threads = 1;
+			for(unsigned int i = 0; i < threads; i++)
+				_workers.push_back(std::thread(&nthread_pool::_work, this));
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom destructor: runs every queued task and joins all workers
+		// ! no task is dropped, so every promise a task owns is set
+		/////////////////////////////////////////////////////////////////////////////////
+		~nthread_pool()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_stop = true;
+			} // lock freed
+			lock.unlock();
+			_condition.notify_all();
+			for(auto it = _workers.begin(); it != _workers.end(); it++)
+				it->join();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! queues a task for the next idle worker
+		// @param1: the task to run
+		/////////////////////////////////////////////////////////////////////////////////
+		auto push(std::function<void()> task) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_tasks.push(std::move(task));
+			} // lock freed
+			lock.unlock();
+			_condition.notify_one();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for checking the amount of worker threads
+		// @return: the amount of worker threads
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_size() -> unsigned int
+		{
+			return _workers.size();
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! wakes up idle workers
+		/////////////////////////////////////////////////////////////////////////////////
+		std::condition_variable _condition;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the queued tasks
+		/////////////////////////////////////////////////////////////////////////////////
+		std::queue<std::function<void()>> _tasks;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the worker threads
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::thread> _workers;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! tells the workers to shut down
+		/////////////////////////////////////////////////////////////////////////////////
+		bool _stop;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the worker loop: waits for tasks and runs them outside of the lock
+		// ! a stopped worker only returns once the queue is empty
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _work() -> void
+		{
+			while(true)
+			{
+				std::function<void()> task;
+				std::unique_lock<std::mutex> lock(_mutex);
+				{ // locked area
+					_condition.wait(lock, [this]{return (_stop || !_tasks.empty());});
+					if(_tasks.empty())
+						return;
+					task = std::move(_tasks.front());
+					_tasks.pop();
+				} // lock freed
+				lock.unlock();
+				task();
+			}
+		}
+}; // end of class nthread_pool
+
+} // end of namespace nresource_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRESOURCE_MANAGER__THREAD_POOL__
@@ -1,42 +1,682 @@
 #include "../nresource_wrapper.hpp"
 #include <SFML/Graphics.hpp>
 
-int main()
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! headless test: loads the fixtures next to this file, no window is opened
+// ! run it from the bin folder, so the fixtures are found at ../test.*
+/////////////////////////////////////////////////////////////////////////////////
+using namespace nengine::nresource_manager;
+
+int failed = 0;
+
+void check(bool condition, char const* name)
+{
+	std::cout << (condition ? "ok      " : "FAILED  ") << name << std::endl;
+	if(!condition)
+		failed++;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
 {
-	nengine::nresource_manager::nresource_wrapper<sf::Texture> resource_management;
-	resource_management.load_texture("Hallo", "../test.png");
-	resource_management.load_font("Hallo", "../test.otf");
-	resource_management.load_soundbuffer("Hallo", "../test.wav");
-	
-	sf::Sprite sprite;
-	sprite.setTexture(resource_management.get_texture("Hallo"));
-	sf::Sprite sprite2;
-	sprite2.setTexture(resource_management.get_texture("Hallo"));
-	sprite2.setPosition(sf::Vector2f(50.0, 50.0));
-	
-	sf::Text text;
-	text.setFont(resource_management.get_font("Hallo"));
-	
-    sf::RenderWindow window(sf::VideoMode(960, 540), "Resource Manager Test");
-	
-	sf::Sound sound;
-	sound.setBuffer(resource_management.get_soundbuffer("Hallo"));
-	sound.play();
-	
-    while (window.isOpen())
-    {
-        sf::Event event;
-        while (window.pollEvent(event))
-        {
-            if (event.type == sf::Event::Closed)
-                window.close();
-        }
-        
-        window.clear(sf::Color::Black);
-        window.draw(sprite);
-        window.draw(sprite2);
-        window.display();
-    }
-	return 0;
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
+std::vector<char> read_file(std::string const& path)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void write_file(std::string const& path, std::vector<char> const& data)
+{
+	std::ofstream file(path.c_str(), std::ios::binary);
+	file.write(data.data(), data.size());
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! narchive: the packed fixtures load like the loose files, a corrupt index
+//   is rejected instead of read out of bounds
+/////////////////////////////////////////////////////////////////////////////////
+void test_archive()
+{
+	narchive_writer writer;
+	check(writer.add_file("../test.png", "../test.png", false)
+		&& writer.add_file("../test.wav", "../test.wav", true)
+		&& writer.add_file("../test.otf", "../test.otf", true), "archive: fixtures packed");
+	check(writer.write("test.narc"), "archive: written");
+
+	{ // the archives are unmapped at the end of the scope, so they can be removed
+		auto start = std::chrono::steady_clock::now();
+		nresource_wrapper<int> loose;
+		loose.load_texture("texture", "../test.png");
+		loose.load_soundbuffer("sound", "../test.wav");
+		loose.load_font("font", "../test.otf");
+		double loose_ms = elapsed_ms(start);
+
+		start = std::chrono::steady_clock::now();
+		nresource_wrapper<int> packed;
+		check(packed.mount_archive("test.narc"), "archive: mounted");
+		packed.load_texture("texture", "../test.png");
+		packed.load_soundbuffer("sound", "../test.wav");
+		packed.load_font("font", "../test.otf");
+		double packed_ms = elapsed_ms(start);
+		std::cout << "        cold start: loose " << loose_ms << " ms, archive " << packed_ms << " ms" << std::endl;
+
+		check((packed.get_texture_stats()._loads == 1) && (packed.get_soundbuffer_stats()._loads == 1) && (packed.get_font_stats()._loads == 1), "archive: every fixture loaded");
+		check(packed.get_texture("texture").getSize() == loose.get_texture("texture").getSize(), "archive: texture equals the loose file");
+		check(packed.get_soundbuffer("sound").getSampleCount() == loose.get_soundbuffer("sound").getSampleCount(), "archive: sound equals the loose file");
+
+		// points the offset of every entry close to the end of the address space
+		std::vector<char> data = read_file("test.narc");
+		std::uint32_t slot_count = 0;
+		std::memcpy(&slot_count, data.data() + 8, 4);
+		for(std::uint32_t i = 0; i < slot_count; i++)
+		{
+			narchive_slot slot;
+			char* at = data.data() + NARCHIVE_HEADER_SIZE + i * sizeof(narchive_slot);
+			std::memcpy(&slot, at, sizeof(slot));
+			if(slot._hash != 0)
+				slot._offset = ~static_cast<std::uint64_t>(0) - 8;
+			std::memcpy(at, &slot, sizeof(slot));
+		}
+		write_file("corrupt.narc", data);
+		narchive corrupt;
+		std::vector<char> buffer;
+		const char* entry = nullptr;
+		std::size_t size = 0;
+		check(corrupt.open("corrupt.narc") && !corrupt.read("../test.png", buffer, entry, size), "archive: wrapping entry offset rejected");
+	}
+	std::remove("test.narc");
+	std::remove("corrupt.narc");
+
+	narchive_writer raw;
+	raw.add_file("../test.otf", "../test.otf", false);
+	raw.write("font.narc");
+	std::shared_ptr<const sf::Font> font;
+	{
+		nresource_wrapper<int> packed;
+		packed.mount_archive("font.narc");
+		packed.load_font("font", "../test.otf");
+		font = packed.get_font_p("font");
+	}
+	font->getGlyph('A', 16, false); // reads the mapped font file after the wrapper is gone
+	check(font.use_count() == 1, "archive: a font read from the mapped file keeps its archive");
+	font.reset(); // unmaps the archive, so it can be removed
+	std::remove("font.narc");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! ntexture_atlas: new pages are cleared, removed space is reused and an empty
+//   page is dropped
+/////////////////////////////////////////////////////////////////////////////////
+void test_atlas()
+{
+	ntexture_atlas atlas(64, 1);
+	sf::Image red;
+	red.create(30, 30, sf::Color::Red);
+	ntexture_region first;
+	ntexture_region second;
+	check(atlas.add(red, first) && atlas.add(red, second), "atlas: two images packed");
+	check(atlas.get_stats()._pages == 1, "atlas: both share one page");
+	check(first._texture->copyToImage().getPixelsPtr()[(30 * 64 + 30) * 4 + 3] == 0, "atlas: the padding of a new page is transparent");
+
+	check(atlas.remove(first), "atlas: image removed");
+	sf::Image small;
+	small.create(10, 10, sf::Color::White);
+	ntexture_region reused;
+	check(atlas.add(small, reused) && (reused._rect.left == first._rect.left) && (reused._rect.top == first._rect.top), "atlas: removed space reused");
+	check(reused._texture->copyToImage().getPixelsPtr()[(10 * 64 + 10) * 4 + 3] == 0, "atlas: reused padding shows no removed pixels");
+	check(atlas.get_stats()._textures == 2, "atlas: texture count follows removals");
+
+	atlas.remove(second);
+	atlas.remove(reused);
+	check(atlas.get_stats()._pages == 0, "atlas: empty page dropped");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! budget: unused values are evicted least recently used first, used ones stay
+/////////////////////////////////////////////////////////////////////////////////
+void test_budget()
+{
+	nengine::nresource_manager::nresource_manager<std::string, int> manager; // an int counts sizeof(int) bytes
+	manager.add("a", 1);
+	manager.add("b", 2);
+	manager.add("c", 3);
+	manager.add("d", 4);
+	manager.set_budget(3 * sizeof(int));
+	check(!manager.test("a") && manager.test("b") && manager.test("c") && manager.test("d"), "budget: the oldest value is evicted");
+	check(manager.get_stats()._bytes == 3 * sizeof(int), "budget: stored bytes fit into the budget");
+
+	manager.get("b"); // b is now as recent as d
+	auto held = manager.get("c");
+	manager.add("e", 5);
+	check(manager.test("b") && manager.test("c") && !manager.test("d") && manager.test("e"), "budget: a used value is kept, the least recently used unused one goes");
+	manager.get("missing");
+	auto stats = manager.get_stats();
+	check((stats._evictions == 2) && (stats._hits == 2) && (stats._misses == 1), "budget: evictions, hits and misses counted");
+
+	manager.set_budget(0);
+	held.reset();
+	manager.clr_unused();
+	check(manager.get_size() == 0, "budget: without a budget every unused value is dropped");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! contention: readers on every core while a writer keeps evicting, every read
+//   returns the value of its own key or the empty value
+/////////////////////////////////////////////////////////////////////////////////
+void test_contention()
+{
+	nengine::nresource_manager::nresource_manager<std::string, int> manager;
+	const int keys = 256;
+	for(int i = 0; i < keys; i++)
+		manager.add("key" + std::to_string(i), i + 1);
+	manager.set_budget(keys * sizeof(int));
+
+	unsigned int threads = std::thread::hardware_concurrency();
+	threads = (threads > 1) ? threads : 2;
+	std::atomic<int> wrong(0);
+	std::vector<std::thread> readers;
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned int t = 0; t < threads; t++)
+	{
+		readers.push_back(std::thread([&manager, &wrong, t]()
+		{
+			for(int i = 0; i < 100000; i++)
+			{
+				int key = (i * 7 + t) % keys;
+				int value = *manager.get("key" + std::to_string(key));
+				if((value != 0) && (value != key + 1))
+					wrong++;
+			}
+		}));
+	}
+	for(int i = keys; i < 4 * keys; i++) // every add evicts one value
+		manager.add("key" + std::to_string(i % keys) + "_", i + 1);
+	for(auto& reader : readers)
+		reader.join();
+	manager.clr_unused(); // values a reader held during an add are evicted now
+	auto stats = manager.get_stats();
+	std::cout << "        contention: " << threads << " readers, " << elapsed_ms(start) << " ms, "
+		<< stats._lock_waits << " lock waits (" << (stats._lock_wait_time / 1e6) << " ms), "
+		<< stats._evictions << " evictions" << std::endl;
+	check(wrong == 0, "contention: every read returns its own value");
+	check(stats._bytes <= keys * sizeof(int), "contention: the budget holds under concurrent reads");
+
+	manager.toggle_resource_storage();
+	manager.add("last", 42);
+	manager.get("last");
+	check(*manager.get_last() == 42, "contention: the last used value is found");
+	manager.clr("last");
+	manager.add("other", 7);
+	check(*manager.get_last() == 0, "contention: a cleared last value is not confused with a new one");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! slots: cleared keys give their slot to the next new key, interned keys keep
+//   theirs so a handle stays valid
+/////////////////////////////////////////////////////////////////////////////////
+void test_slots()
+{
+	nengine::nresource_manager::nresource_manager<std::string, int> manager;
+	manager.toggle_resource_storage();
+	auto handle = manager.intern("kept");
+	manager.add("kept", 1);
+	for(int i = 0; i < 1000; i++) // every key is cleared before the next is added
+	{
+		manager.add("temporary" + std::to_string(i), i);
+		manager.clr("temporary" + std::to_string(i));
+	}
+	manager.clr("kept");
+	manager.add("kept", 2);
+	check(*manager.get(handle) == 2, "slots: a handle survives clearing and adding its key");
+	check(!manager.test("temporary0") && (manager.get_size() == 1), "slots: cleared keys are gone");
+	manager.add("last", 3);
+	manager.get("last");
+	manager.clr("last");
+	for(int i = 0; i < 64; i++) // one of them reuses the slot of "last"
+		manager.add("new" + std::to_string(i), 4);
+	check(*manager.get_last() == 0, "slots: get_last() does not follow a reused slot");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! copies: a value handed over by move, emplace or adopt is never copied
+/////////////////////////////////////////////////////////////////////////////////
+struct ncounted
+{
+	static int copies;
+	int _value;
+
+	ncounted(int value = 0) : _value(value) {}
+	ncounted(ncounted const& other) : _value(other._value) {copies++;}
+	ncounted(ncounted&& other) : _value(other._value) {}
+	auto operator=(ncounted const& other) -> ncounted& {_value = other._value; copies++; return *this;}
+	auto operator=(ncounted&& other) -> ncounted& {_value = other._value; return *this;}
+	auto operator==(ncounted const& other) const -> bool {return _value == other._value;}
+};
+int ncounted::copies = 0;
+
+void test_copies()
+{
+	nengine::nresource_manager::nresource_manager<std::string, ncounted> manager;
+	ncounted::copies = 0;
+	manager.add("moved", ncounted(1));
+	manager.emplace("emplaced", 2);
+	manager.adopt("adopted", std::make_shared<ncounted>(3));
+	manager.swap("moved", ncounted(4));
+	check(ncounted::copies == 0, "copies: add(&&), emplace, adopt and swap(&&) make no copy");
+	check((manager.get("moved")->_value == 4) && (manager.get("emplaced")->_value == 2) && (manager.get("adopted")->_value == 3), "copies: the values are stored");
+	ncounted copied(5);
+	manager.add("copied", copied);
+	check(ncounted::copies == 1, "copies: add(const&) copies exactly once");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! image cache: a warm start reads the decoded pixels, a corrupt cache file is
+//   a miss instead of a huge allocation
+/////////////////////////////////////////////////////////////////////////////////
+void test_image_cache()
+{
+	auto start = std::chrono::steady_clock::now();
+	{
+		nresource_wrapper<int> cold;
+		cold.set_image_cache("cache");
+		cold.load_texture("texture", "../test.png");
+	}
+	double cold_ms = elapsed_ms(start);
+	start = std::chrono::steady_clock::now();
+	nresource_wrapper<int> warm;
+	warm.set_image_cache("cache");
+	warm.load_texture("texture", "../test.png");
+	double warm_ms = elapsed_ms(start);
+	std::cout << "        image cache: cold " << cold_ms << " ms, warm " << warm_ms << " ms" << std::endl;
+
+	sf::Image decoded;
+	decoded.loadFromFile("../test.png");
+	check(warm.get_texture("texture").getSize() == decoded.getSize(), "image cache: the warm texture equals the decoded file");
+
+	nimage_cache cache;
+	cache.set_directory("cache", false);
+	sf::Image cached;
+	check(cache.write("../test.png", decoded) && cache.read("../test.png", cached) && (cached.getSize() == decoded.getSize())
+		&& (std::memcmp(cached.getPixelsPtr(), decoded.getPixelsPtr(), decoded.getSize().x * decoded.getSize().y * 4) == 0), "image cache: uncompressed pixels read back");
+
+	std::ostringstream name;
+	name << "cache/" << std::hex << nhash(std::string("../test.png")) << ".nimg";
+	std::vector<char> data = read_file(name.str());
+	nimage_cache_header header;
+	std::memcpy(&header, data.data(), sizeof(header));
+	nimage_cache_header corrupt = header;
+	corrupt._stored_size = static_cast<std::uint64_t>(1) << 50;
+	std::memcpy(data.data(), &corrupt, sizeof(corrupt));
+	write_file(name.str(), data);
+	check(!cache.read("../test.png", cached), "image cache: a huge stored size is a miss");
+
+	corrupt = header;
+	corrupt._width = 0x10000;
+	corrupt._height = 0x10000;
+	corrupt._flags = NIMAGE_CACHE_COMPRESSED;
+	std::memcpy(data.data(), &corrupt, sizeof(corrupt));
+	write_file(name.str(), data);
+	check(!cache.read("../test.png", cached), "image cache: a huge image size is a miss");
+
+	data.resize(data.size() / 2);
+	std::memcpy(data.data(), &header, sizeof(header));
+	write_file(name.str(), data);
+	check(!cache.read("../test.png", cached), "image cache: a truncated file is a miss");
+
+	std::remove(name.str().c_str());
+	std::remove("cache");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! dedup: an alias keeps the memory counted once its original is cleared, the
+//   origins of an erased key are forgotten
+/////////////////////////////////////////////////////////////////////////////////
+void test_dedup()
+{
+	nengine::nresource_manager::nresource_manager<std::string, int> manager;
+	manager.toggle_resource_storage();
+	manager.add("original", 1);
+	manager.alias("alias", "original");
+	check(manager.get_stats()._bytes == sizeof(int), "dedup: an alias is counted once");
+	manager.clr("original");
+	check(manager.get_stats()._bytes == sizeof(int), "dedup: the alias takes over the memory of a cleared original");
+	manager.swap("alias", 2);
+	check(manager.get_stats()._bytes == sizeof(int), "dedup: swapping the last key frees the old value");
+	manager.clr("alias");
+	check(manager.get_stats()._bytes == 0, "dedup: clearing the last key frees the memory");
+
+	write_file("x.img", std::vector<char>(32, 'x')); // the test images are four pixels wide
+	write_file("y.img", std::vector<char>(48, 'y'));
+	nresource_wrapper<int> wrapper;
+	wrapper.load_texture("first", "x.img");
+	wrapper.clr_unused();
+	wrapper.load_texture("first", "y.img");
+	wrapper.load_texture("second", "x.img");
+	check(wrapper.get_texture("second").getSize().y == 2, "dedup: a cleared key is no origin of its old file");
+	check(wrapper.get_dedup_stats()._aliases == 0, "dedup: nothing was aliased");
+	std::remove("x.img");
+	std::remove("y.img");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! collect: the incremental clr_unused() drops at most the given amount of
+//   values per call, with and without a budget
+/////////////////////////////////////////////////////////////////////////////////
+void test_collect()
+{
+	nengine::nresource_manager::nresource_manager<std::string, int> manager;
+	for(int i = 0; i < 1000; i++)
+		manager.add("key" + std::to_string(i), i);
+	manager.clr_unused(10);
+	check(manager.get_size() == 990, "collect: ten slots checked without a budget");
+
+	nengine::nresource_manager::nresource_manager<std::string, int> budgeted;
+	budgeted.set_budget(100 * sizeof(int));
+	{ // held values cannot be evicted, so the manager ends up over its budget
+		std::vector<std::shared_ptr<const int>> held;
+		for(int i = 0; i < 1000; i++)
+			held.push_back(budgeted.add("key" + std::to_string(i), i));
+	}
+	auto evictions = budgeted.get_stats()._evictions;
+	check(!budgeted.clr_unused(8) && (budgeted.get_stats()._evictions - evictions == 8), "collect: eight values evicted per call over the budget");
+	int calls = 1; // 892 values above the budget are left, eight per call
+	while(!budgeted.clr_unused(8))
+		calls++;
+	check((calls == 112) && (budgeted.get_size() == 100), "collect: the budget is reached in bounded steps");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! music: a streamed track keeps only its source, a soundbuffer holds every
+//   decoded sample
+/////////////////////////////////////////////////////////////////////////////////
+void test_music()
+{
+	nresource_wrapper<int> wrapper;
+	auto start = std::chrono::steady_clock::now();
+	wrapper.load_soundbuffer("sound", "../test.wav");
+	double sound_ms = elapsed_ms(start);
+	start = std::chrono::steady_clock::now();
+	wrapper.load_music("music", "../test.wav");
+	double music_ms = elapsed_ms(start);
+	auto sound = wrapper.get_soundbuffer_stats();
+	auto music = wrapper.get_music_stats();
+	std::cout << "        music: soundbuffer " << sound._bytes << " bytes in " << sound_ms << " ms, music " << music._bytes << " bytes in " << music_ms << " ms" << std::endl;
+	check((music._loads == 1) && (music._bytes < sound._bytes), "music: a loose track needs less memory than its soundbuffer");
+	auto first = wrapper.open_music("music");
+	auto second = wrapper.open_music("music");
+	check((first != nullptr) && (second != nullptr) && (first != second), "music: every open gets a stream of its own");
+	check(wrapper.open_music("missing") == nullptr, "music: a missing track opens nothing");
+
+	narchive_writer writer;
+	writer.add_file("../test.wav", "../test.wav", false);
+	writer.write("music.narc");
+	std::shared_ptr<sf::Music> playing;
+	{
+		nresource_wrapper<int> packed;
+		packed.mount_archive("music.narc");
+		packed.load_music("music", "../test.wav");
+		playing = packed.open_music("music");
+		check((packed.get_music_stats()._bytes == music._bytes) && (playing != nullptr), "music: a mapped archive entry is streamed without a copy");
+	}
+	playing->getDuration(); // reads the mapped entry after the wrapper is gone
+	check(playing.use_count() == 1, "music: a stream of a mapped entry keeps its archive");
+	playing.reset(); // unmaps the archive, so it can be removed
+	std::remove("music.narc");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! hot reload: an edited file updates its keys in place, a key of another file
+//   that shared the pixels keeps them, an atlas texture may change its size
+/////////////////////////////////////////////////////////////////////////////////
+auto wait_for_reload(nresource_wrapper<int>& wrapper, std::function<bool()> reloaded) -> double
+{
+	auto start = std::chrono::steady_clock::now();
+	while(!reloaded() && (elapsed_ms(start) < 2000))
+	{
+		wrapper.process();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return elapsed_ms(start);
+}
+
+void test_hot_reload()
+{
+	write_file("own.img", std::vector<char>(32, 'o')); // the test images are four pixels wide
+	write_file("first.img", std::vector<char>(32, 's'));
+	write_file("second.img", std::vector<char>(32, 's'));
+	write_file("region.img", std::vector<char>(32, 'r'));
+	nresource_wrapper<int> wrapper;
+	wrapper.set_hot_reload(true);
+	wrapper.load_texture("own", "own.img");
+	wrapper.load_texture("own_alias", "own.img");
+	wrapper.load_texture("first", "first.img");
+	wrapper.load_texture("second", "second.img");
+	wrapper.load_texture_atlas("region", "region.img");
+	auto own = wrapper.get_texture_p("own");
+	check(wrapper.get_dedup_stats()._aliases == 2, "hot reload: a file and a content alias");
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(1100)); // a new modification time
+	write_file("own.img", std::vector<char>(32, 'n'));
+	double latency = wait_for_reload(wrapper, [&own]() {return own->copyToImage().getPixelsPtr()[0] == 'n';});
+	std::cout << "        hot reload: visible after " << latency << " ms" << std::endl;
+	check(own->copyToImage().getPixelsPtr()[0] == 'n', "hot reload: the texture is updated in place");
+	check(wrapper.get_texture_p("own_alias") == own, "hot reload: a key of the same file still shares it");
+
+	write_file("first.img", std::vector<char>(48, 'e'));
+	wait_for_reload(wrapper, [&wrapper]() {return wrapper.get_texture("first").getSize().y == 3;});
+	check(wrapper.get_texture("first").getSize().y == 3, "hot reload: the edited key is reloaded");
+	check(wrapper.get_texture("second").copyToImage().getPixelsPtr()[0] == 's', "hot reload: a key of another file keeps its pixels");
+	write_file("third.img", std::vector<char>(32, 's'));
+	write_file("fourth.img", std::vector<char>(48, 'e'));
+	wrapper.load_texture("third", "third.img");
+	wrapper.load_texture("fourth", "fourth.img");
+	check(wrapper.get_texture("third").copyToImage().getPixelsPtr()[0] == 's', "hot reload: the old content is not served by the edited key");
+	check(wrapper.get_texture_p("fourth") == wrapper.get_texture_p("first"), "hot reload: the new content is deduplicated");
+
+	write_file("region.img", std::vector<char>(64, 'g'));
+	wait_for_reload(wrapper, [&wrapper]() {return wrapper.get_texture_region("region")->_rect.height == 4;});
+	check(wrapper.get_texture_region("region")->_rect.height == 4, "hot reload: an atlas texture changes its size");
+
+	std::remove("own.img");
+	std::remove("first.img");
+	std::remove("second.img");
+	std::remove("third.img");
+	std::remove("fourth.img");
+	std::remove("region.img");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! async: a second load of a running key shares its future, a texture is
+//   stored by process(), a destroyed wrapper leaves no future without a value
+/////////////////////////////////////////////////////////////////////////////////
+auto wait_for(nresource_wrapper<int>& wrapper, std::shared_future<bool> const& future) -> bool
+{
+	auto start = std::chrono::steady_clock::now();
+	while((future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) && (elapsed_ms(start) < 2000))
+	{
+		wrapper.process();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) && future.get();
+}
+
+void test_async()
+{
+	nresource_wrapper<int> wrapper;
+	auto texture = wrapper.load_texture_async("texture", "../test.png");
+	auto shared = wrapper.load_texture_async("texture", "../test.png");
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	check(texture.wait_for(std::chrono::seconds(0)) != std::future_status::ready, "async: a texture waits for process()");
+	check(wait_for(wrapper, texture) && wait_for(wrapper, shared) && (wrapper.get_texture_stats()._loads == 1), "async: the texture is stored by process()");
+	check(&texture.get() == &shared.get(), "async: a running texture load is shared"); // one shared state holds one value
+
+	auto font = wrapper.load_font_async("font", "../test.otf");
+	auto font_shared = wrapper.load_font_async("font", "../test.otf");
+	check(wait_for(wrapper, font) && wait_for(wrapper, font_shared) && (wrapper.get_font_stats()._loads == 1), "async: the font is stored");
+	check(&font.get() == &font_shared.get(), "async: a running font load is shared");
+
+	auto sound = wrapper.load_soundbuffer_async("sound", "../test.wav");
+	auto sound_shared = wrapper.load_soundbuffer_async("sound", "../test.wav");
+	check(wait_for(wrapper, sound) && wait_for(wrapper, sound_shared) && (wrapper.get_soundbuffer_stats()._loads == 1), "async: the sound is stored");
+	check(&sound.get() == &sound_shared.get(), "async: a running sound load is shared");
+	check(!wait_for(wrapper, wrapper.load_soundbuffer_async("missing", "missing.wav")), "async: a missing file fails its future");
+
+	std::vector<std::shared_future<bool>> futures;
+	{ // nothing is processed before the wrapper is destroyed
+		nresource_wrapper<int> dropped;
+		for(int i = 0; i < 8; i++)
+			futures.push_back(dropped.load_texture_async("texture" + std::to_string(i), "../test.png"));
+		futures.push_back(dropped.preload(nmanifest().add_texture("preloaded", "../test.png")));
+	}
+	bool dropped = true;
+	for(auto& future : futures)
+		dropped = dropped && (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) && !future.get();
+	check(dropped, "async: a destroyed wrapper fails every pending future");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! preload: stored entries count as done from the start, the progress only
+//   grows up to the total, a failed entry fails the whole batch
+/////////////////////////////////////////////////////////////////////////////////
+void test_preload()
+{
+	nresource_wrapper<int> wrapper;
+	wrapper.load_texture("stored", "../test.png");
+	wrapper.load_soundbuffer("sound", "../test.wav");
+	std::vector<unsigned int> progress;
+	unsigned int total = 0;
+	auto batch = wrapper.preload(nmanifest()
+		.add_texture("stored", "../test.png")
+		.add_soundbuffer("sound", "../test.wav")
+		.add_texture("texture", "../test.png")
+		.add_font("font", "../test.otf"),
+		[&progress, &total](unsigned int done, unsigned int all) {progress.push_back(done); total = all;});
+	check(wait_for(wrapper, batch), "preload: the batch succeeds");
+	bool growing = !progress.empty() && (progress.front() >= 2);
+	for(std::size_t i = 1; i < progress.size(); i++)
+		growing = growing && (progress[i] > progress[i - 1]);
+	check(growing && (total == 4) && (progress.back() == 4), "preload: the progress starts at the stored entries and grows to the total");
+
+	progress.clear();
+	batch = wrapper.preload(nmanifest().add_texture("stored", "../test.png"), [&progress](unsigned int done, unsigned int) {progress.push_back(done);});
+	check((batch.wait_for(std::chrono::seconds(0)) == std::future_status::ready) && batch.get() && (progress.size() == 1) && (progress[0] == 1), "preload: a stored manifest is done at once");
+
+	progress.clear();
+	batch = wrapper.preload(nmanifest()
+		.add_texture("other", "../test.png")
+		.add_texture("missing", "missing.png"),
+		[&progress](unsigned int done, unsigned int) {progress.push_back(done);});
+	check(!wait_for(wrapper, batch) && (batch.wait_for(std::chrono::seconds(0)) == std::future_status::ready), "preload: a missing entry fails the batch");
+	check(!progress.empty() && (progress.back() == 2) && (wrapper.get_texture_p("other") == wrapper.get_texture_p("stored")), "preload: the other entries are loaded anyway");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! stats: load times land in their power of two bucket, hits and misses are
+//   counted by get(), the dump writes a line per kind and waits its interval
+/////////////////////////////////////////////////////////////////////////////////
+void test_stats()
+{
+	nengine::nresource_manager::nresource_manager<std::string, int> manager;
+	manager.record_load(std::chrono::nanoseconds(0));
+	manager.record_load(std::chrono::microseconds(500));
+	manager.record_load(std::chrono::milliseconds(3));
+	manager.record_load(std::chrono::hours(1));
+	auto stats = manager.get_stats();
+	check(stats._load_histogram[0] == 2, "stats: loads below 1 ms are in the first bucket");
+	check(stats._load_histogram[2] == 1, "stats: a 3 ms load is in the 2-3 ms bucket");
+	check(stats._load_histogram[NRESOURCE_LOAD_BUCKETS - 1] == 1, "stats: a longer load than the buckets is in the last one");
+	check(stats._load_time_max == static_cast<unsigned long long>(std::chrono::nanoseconds(std::chrono::hours(1)).count()), "stats: the slowest load is kept");
+
+	manager.add("key", 1);
+	manager.get("key");
+	manager.get("key");
+	manager.get("missing");
+	stats = manager.get_stats();
+	check((stats._hits == 2) && (stats._misses == 1), "stats: get() counts hits and misses");
+
+	nresource_wrapper<int> wrapper;
+	wrapper.load_texture("texture", "../test.png");
+	std::ostringstream dump;
+	wrapper.dump_stats(dump);
+	std::istringstream lines(dump.str());
+	std::vector<std::string> kinds;
+	for(std::string line; std::getline(lines, line);)
+		kinds.push_back(line.substr(0, line.find(':')));
+	check((kinds.size() == 7) && (kinds[0] == "resources") && (kinds[1] == "textures") && (kinds[2] == "atlas") && (kinds[3] == "fonts")
+		&& (kinds[4] == "soundbuffers") && (kinds[5] == "music"), "stats: the dump writes one line per kind and a summary");
+
+	int dumps = 0;
+	unsigned long long loads = 0;
+	wrapper.set_stats_dump(100, [&dumps, &loads](nresource_snapshot const& snapshot) {dumps++; loads = snapshot._textures._loads;});
+	wrapper.process();
+	check(dumps == 0, "stats: nothing is dumped before the interval");
+	std::this_thread::sleep_for(std::chrono::milliseconds(110));
+	wrapper.process();
+	wrapper.process();
+	check((dumps == 1) && (loads == 1), "stats: process() dumps once per interval");
+	wrapper.set_stats_dump(0, nullptr);
+	std::this_thread::sleep_for(std::chrono::milliseconds(110));
+	wrapper.process();
+	check(dumps == 1, "stats: an interval of 0 disables the dump");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! glyphs: every size, outline and character is warmed once, an asynchronous
+//   font with glyphs is only done after process() warmed them
+/////////////////////////////////////////////////////////////////////////////////
+void test_glyphs()
+{
+	nglyph_set glyphs;
+	check(glyphs.add_characters("abc").is_empty(), "glyphs: nothing to warm without a size");
+	glyphs.add_characters("cab").add_size(12).add_size(24).add_size(12).add_outline(1.0f).add_outline(0.0f).add_outline(1.0f);
+	sf::Font font;
+	font.loadFromFile("../test.otf");
+	check(glyphs.warm(font) == 3 * 2 * 2, "glyphs: sizes times outlines times characters are warmed, duplicates once");
+	check(nglyph_set().add_ascii().add_ascii().add_size(8).warm(font) == 95, "glyphs: the printable ascii characters are added once");
+
+	nresource_wrapper<int> wrapper;
+	wrapper.load_font("loaded", "../test.otf", nglyph_set().add_characters("a").add_size(40));
+	check(wrapper.get_font("loaded").getTexture(40).getSize().x > 0, "glyphs: load_font() warms at once");
+
+	auto future = wrapper.load_font_async("font", "../test.otf", nglyph_set().add_characters("a").add_size(48));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50)); // the font is loaded and deduplicated meanwhile
+	check(future.wait_for(std::chrono::seconds(0)) != std::future_status::ready, "glyphs: a loaded font waits for process() to warm it");
+	check(wrapper.get_font("font").getTexture(48).getSize().x == 0, "glyphs: nothing is warmed on the worker");
+	wrapper.process();
+	check((future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) && future.get(), "glyphs: process() sets the future");
+	check(wrapper.get_font("font").getTexture(48).getSize().x > 0, "glyphs: the glyphs are warmed before the future is set");
+}
+
+int main()
+{
+	test_archive();
+	test_atlas();
+	test_budget();
+	test_contention();
+	test_slots();
+	test_copies();
+	test_image_cache();
+	test_dedup();
+	test_collect();
+	test_music();
+	test_hot_reload();
+	test_async();
+	test_preload();
+	test_stats();
+	test_glyphs();
+
+	if(failed == 0)
+		std::cout << "all passed" << std::endl;
+	return failed;
+}
@@ -0,0 +1,69 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! npacker: packs loose resource files into a narchive
+//
+// usage: npacker [-c] <archive> <file> [<file> ...]
+//   -c: compress the entries, entries that do not shrink are stored raw
+//
+// every file is stored under the path exactly as it is passed, so run the
+// packer from the directory your program loads its resources from
+/////////////////////////////////////////////////////////////////////////////////
+#include "../nresource_archive.hpp"
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+	bool compress = false;
+	int first = 1;
+	if((argc > 1) && (std::string(argv[1]) == "-c"))
+	{
+		compress = true;
+		first++;
+	}
+	if(argc - first < 2)
+	{
+		std::cerr << "usage: npacker [-c] <archive> <file> [<file> ...]" << std::endl;
+		return 1;
+	}
+
+	nengine::nresource_manager::narchive_writer writer;
+	for(int i = first + 1; i < argc; i++)
+	{
+		if(!writer.add_file(argv[i], argv[i], compress))
+		{
+			std::cerr << "could not add " << argv[i] << std::endl;
+			return 1;
+		}
+	}
+	if(!writer.write(argv[first]))
+	{
+		std::cerr << "could not write " << argv[first] << std::endl;
+		return 1;
+	}
+	return 0;
+}
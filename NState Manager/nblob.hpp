@@ -0,0 +1,191 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NSTATE_MANAGER__NBLOB__
+#define __NENGINE__NSTATE_MANAGER__NBLOB__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! cstring for copying the values
+// ! string for the string values
+// ! type_traits for rejecting values that are not plain, gcc before 5 lacks
+//   std::is_trivially_copyable so the check is skipped there
+// ! vector for the blob
+/////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nstate_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nstate_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! writes plain values and strings into the blob of a suspended nstate
+// ! the values are stored back to back without any padding or type info, so
+//   they have to be read in the same order by a nblob_reader
+/////////////////////////////////////////////////////////////////////////////////
+class nblob_writer
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nblob_writer(const nblob_writer&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nblob_writer& operator=(const nblob_writer&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		// @param1: the blob to append to
+		/////////////////////////////////////////////////////////////////////////////////
+		explicit nblob_writer(std::vector<char>& blob)
+			: _blob(blob)
+		{}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! appends a plain value
+		// @param1: the value, e.g. a number, an enum or a sf::Vector2f, nothing that
+		//          holds a pointer
+		// @return: the writer itself to chain the calls
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename T>
+		auto write(T const& value) -> nblob_writer&
+		{
+#if !defined(__GNUC__) || (__GNUC__ >= 5) || defined(__clang__)
+			static_assert(std::is_trivially_copyable<T>::value, "nblob_writer::write() only copies plain values, write their members instead");
+#endif
+			char const* bytes = reinterpret_cast<char const*>(&value);
+			_blob.insert(_blob.end(), bytes, bytes + sizeof(T));
+			return *this;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! appends a string with its length
+		// @param1: the string
+		// @return: the writer itself to chain the calls
+		/////////////////////////////////////////////////////////////////////////////////
+		auto write(std::string const& value) -> nblob_writer&
+		{
+			write(static_cast<unsigned int>(value.size()));
+			_blob.insert(_blob.end(), value.begin(), value.end());
+			return *this;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! appends a string literal with its length, read back as a std::string
+		// @param1: the string
+		// @return: the writer itself to chain the calls
+		/////////////////////////////////////////////////////////////////////////////////
+		auto write(char const* value) -> nblob_writer&
+		{
+			return write(std::string(value));
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the blob to append to
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<char>& _blob;
+}; // end of class nblob_writer
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! reads the values written by a nblob_writer back in the same order
+/////////////////////////////////////////////////////////////////////////////////
+class nblob_reader
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nblob_reader(const nblob_reader&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nblob_reader& operator=(const nblob_reader&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		// @param1: the blob to read from
+		/////////////////////////////////////////////////////////////////////////////////
+		explicit nblob_reader(std::vector<char> const& blob)
+			: _blob(blob)
+			, _offset(0)
+		{}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! reads the next plain value
+		// @param1: the value to read into, untouched if the blob is exhausted
+		// @return: false if the blob is too short
+		/////////////////////////////////////////////////////////////////////////////////
+		template <typename T>
+		auto read(T& value) -> bool
+		{
+#if !defined(__GNUC__) || (__GNUC__ >= 5) || defined(__clang__)
+			static_assert(std::is_trivially_copyable<T>::value, "nblob_reader::read() only copies plain values, read their members instead");
+#endif
+			if((_blob.size() - _offset) < sizeof(T))
+			{
+				return false;
+			}
+			std::memcpy(&value, _blob.data() + _offset, sizeof(T));
+			_offset += sizeof(T);
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! reads the next string
+		// @param1: the string to read into, untouched if the blob is exhausted
+		// @return: false if the blob is too short
+		/////////////////////////////////////////////////////////////////////////////////
+		auto read(std::string& value) -> bool
+		{
+			unsigned int size = 0;
+			std::size_t offset = _offset;
+			if((!read(size)) || ((_blob.size() - _offset) < size))
+			{
+				_offset = offset;
+				return false;
+			}
+			value.assign(_blob.data() + _offset, size);
+			_offset += size;
+			return true;
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the blob to read from
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<char> const& _blob;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the position of the next value
+		/////////////////////////////////////////////////////////////////////////////////
+		std::size_t _offset;
+}; // end of class nblob_reader
+
+} // end of namespace nstate_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NSTATE_MANAGER__NBLOB__
@@ -0,0 +1,520 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NSTATE_MANAGER__NPROFILER__
+#define __NENGINE__NSTATE_MANAGER__NPROFILER__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! algorithm for sorting the recorded times
+// ! atomic for the lock-free ring buffers
+// ! chrono for the timers
+// ! memory for the profiles
+// ! mutex for thread safety of the profile names
+// ! ostream for writing the trace
+// ! string for the state names
+// ! vector for the ring buffers
+/////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the amount of handle(), update() and draw() calls kept per state for the
+//   percentiles of the phases and the trace
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NPROFILER_SAMPLES
+#define NPROFILER_SAMPLES 1024
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the amount of frames kept per state for the percentiles of the frame time
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NPROFILER_FRAMES
+#define NPROFILER_FRAMES 256
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the amount of differently named states that are profiled, the calls of
+//   further states are not recorded
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NPROFILER_PROFILES
+#define NPROFILER_PROFILES 64
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nstate_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nstate_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the timed phases of a state, a frame ends with the draw() of a state
+/////////////////////////////////////////////////////////////////////////////////
+enum class nphase
+{
+	HANDLE,
+	UPDATE,
+	DRAW
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! struct nphase_stats to report the times of a phase in nanoseconds
+// ! _calls: the amount of recorded calls the percentiles are taken from
+// ! _p50, _p90, _p99: the percentiles
+// ! _max: the longest recorded call
+/////////////////////////////////////////////////////////////////////////////////
+struct nphase_stats
+{
+	unsigned long long _calls;
+	unsigned long long _p50;
+	unsigned long long _p90;
+	unsigned long long _p99;
+	unsigned long long _max;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! struct nprofile_stats to report the times of a single state
+// ! _frame: everything a state ran from one draw() to the next one included
+/////////////////////////////////////////////////////////////////////////////////
+struct nprofile_stats
+{
+	std::string _name;
+	nphase_stats _handle;
+	nphase_stats _update;
+	nphase_stats _draw;
+	nphase_stats _frame;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the nprofiler
+// ! records the handle(), update() and draw() calls of every state into ring
+//   buffers without locking, a state is identified by its name
+/////////////////////////////////////////////////////////////////////////////////
+class nprofiler
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nprofiler(const nprofiler&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nprofiler& operator=(const nprofiler&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		/////////////////////////////////////////////////////////////////////////////////
+		nprofiler()
+			: _mutex()
+			, _enabled(false)
+			, _epoch(std::chrono::steady_clock::now())
+			, _frame(0)
+			, _profiles(NPROFILER_PROFILES)
+			, _count(0)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! enables or disables the recording, disabled by default
+		// @param1: indicator if the calls are recorded
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_enabled(bool enabled) -> void
+		{
+			_enabled = enabled;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find out if the calls are recorded
+		// @return: indicator if the recording is enabled
+		/////////////////////////////////////////////////////////////////////////////////
+		inline auto is_enabled() const -> bool {return _enabled;}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the profile of a state, it is created on first use
+		// @param1: the name of the state
+		// @return: the index of the profile for record(), NPROFILER_PROFILES if every
+		//          profile is taken, record() ignores it then
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_profile(std::string const& name) -> std::size_t
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				for(std::size_t i = 0; i < _count; i++)
+				{
+					if(_profiles[i]->_name == name)
+						return i;
+				}
+				if(_count == NPROFILER_PROFILES)
+					return NPROFILER_PROFILES;
+				_profiles[_count].reset(new nprofile(name));
+				return _count++;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! records a single call, the draw() of a state ends its frame
+		// ! takes no lock, the call is written into the ring buffers of its profile
+		//   and published by the sequence number of its slot
+		// @param1: the index of the profile
+		// @param2: the phase
+		// @param3: when the call started
+		// @param4: when the call returned
+		/////////////////////////////////////////////////////////////////////////////////
+		auto record(std::size_t profile, nphase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) -> void
+		{
+			if(profile >= NPROFILER_PROFILES)
+			{
+				return;
+			}
+			nprofile& recorded = *_profiles[profile];
+			nsample sample;
+			sample._phase = phase;
+			sample._start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - _epoch).count();
+			sample._time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+			sample._frame = _frame.load(std::memory_order_relaxed);
+			_add(recorded._samples, sample);
+			if(phase != nphase::DRAW)
+			{
+				recorded._running.fetch_add(sample._time, std::memory_order_relaxed);
+				return;
+			}
+			sample._time += recorded._running.exchange(0, std::memory_order_relaxed);
+			_add(recorded._frames, sample);
+			_frame.fetch_add(1, std::memory_order_relaxed);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the percentiles of every profiled state
+		// @return: the stats in the order the states were profiled first
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_stats() -> std::vector<nprofile_stats>
+		{
+			std::vector<nprofile_stats> stats;
+			std::vector<unsigned long long> times[3];
+			std::vector<nsample> samples;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				for(std::size_t i = 0; i < _count; i++)
+				{
+					nprofile_stats profile_stats;
+					profile_stats._name = _profiles[i]->_name;
+					for(auto& phase : times)
+						phase.clear();
+					_get(_profiles[i]->_samples, samples);
+					for(auto const& sample : samples)
+						times[static_cast<int>(sample._phase)].push_back(sample._time);
+					profile_stats._handle = _get_stats(times[static_cast<int>(nphase::HANDLE)]);
+					profile_stats._update = _get_stats(times[static_cast<int>(nphase::UPDATE)]);
+					profile_stats._draw = _get_stats(times[static_cast<int>(nphase::DRAW)]);
+					std::vector<unsigned long long> frames;
+					_get(_profiles[i]->_frames, samples);
+					for(auto const& sample : samples)
+						frames.push_back(sample._time);
+					profile_stats._frame = _get_stats(frames);
+					stats.push_back(profile_stats);
+				}
+			} // lock freed
+			return stats;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! writes the recorded calls of the last frames in the Chrome trace event
+		//   format, e.g. for chrome://tracing, every state gets an own row
+		// @param1: the stream to write to
+		// @param2: the amount of frames
+		/////////////////////////////////////////////////////////////////////////////////
+		auto dump_trace(std::ostream& stream, unsigned int frames) -> void
+		{
+			static const char* phases[] = {"handle", "update", "draw"};
+			std::vector<nsample> samples;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				bool first = true;
+				unsigned long long frame = _frame.load(std::memory_order_relaxed);
+				stream << "{\"traceEvents\":[";
+				for(std::size_t i = 0; i < _count; i++)
+				{
+					stream << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << (i + 1) << ",\"args\":{\"name\":\"";
+					_dump_string(stream, _profiles[i]->_name);
+					stream << "\"}}";
+					first = false;
+					_get(_profiles[i]->_samples, samples);
+					for(auto const& sample : samples)
+					{
+						if((sample._frame + frames) < frame)
+							continue;
+						stream << ",\n{\"name\":\"" << phases[static_cast<int>(sample._phase)] << "\",\"cat\":\"state\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (i + 1)
+							<< ",\"ts\":" << (sample._start / 1000) << "." << _get_fraction(sample._start)
+							<< ",\"dur\":" << (sample._time / 1000) << "." << _get_fraction(sample._time)
+							<< ",\"args\":{\"frame\":" << sample._frame << "}}";
+					}
+				}
+				stream << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! clears every recorded call
+		/////////////////////////////////////////////////////////////////////////////////
+		auto clr() -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				for(std::size_t i = 0; i < _count; i++)
+				{
+					_profiles[i]->_samples._cleared = _profiles[i]->_samples._claimed.load();
+					_profiles[i]->_frames._cleared = _profiles[i]->_frames._claimed.load();
+					_profiles[i]->_running = 0;
+				}
+			} // lock freed
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! a single recorded call, the times in nanoseconds since the construction
+		// ! a frame is kept as the draw() that ended it with the time of the frame
+		/////////////////////////////////////////////////////////////////////////////////
+		struct nsample
+		{
+			nphase _phase;
+			unsigned long long _frame;
+			unsigned long long _start;
+			unsigned long long _time;
+		};
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! a slot of a ring buffer, _sequence is the position of the sample plus one
+		//   once it is written and 0 while it is written
+		/////////////////////////////////////////////////////////////////////////////////
+		struct nslot
+		{
+			std::atomic<unsigned long long> _sequence;
+			std::atomic<int> _phase;
+			std::atomic<unsigned long long> _frame;
+			std::atomic<unsigned long long> _start;
+			std::atomic<unsigned long long> _time;
+		};
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! a ring buffer written without locking
+		// ! _claimed: the amount of samples ever added
+		// ! _cleared: the position of the first sample after the last clr()
+		/////////////////////////////////////////////////////////////////////////////////
+		struct nring
+		{
+			nring(std::size_t capacity) : _slots(capacity), _claimed(0), _cleared(0) {}
+			std::vector<nslot> _slots;
+			std::atomic<unsigned long long> _claimed;
+			std::atomic<unsigned long long> _cleared;
+		};
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the ring buffers of a single state
+		// ! _running: the time of the frame that did not reach its draw() yet
+		/////////////////////////////////////////////////////////////////////////////////
+		struct nprofile
+		{
+			nprofile(std::string const& name) : _name(name), _samples(NPROFILER_SAMPLES), _frames(NPROFILER_FRAMES), _running(0) {}
+			const std::string _name;
+			nring _samples;
+			nring _frames;
+			std::atomic<unsigned long long> _running;
+		};
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety of the profile names, record() does not lock it
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! if the calls are recorded
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<bool> _enabled;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the start of the recorded times
+		/////////////////////////////////////////////////////////////////////////////////
+		const std::chrono::steady_clock::time_point _epoch;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the amount of frames, counted by the draw() calls of every state
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<unsigned long long> _frame;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the profiles of every state, allocated up to NPROFILER_PROFILES so a
+		//   new profile never moves the ones record() writes to
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<std::unique_ptr<nprofile>> _profiles;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the amount of created profiles
+		/////////////////////////////////////////////////////////////////////////////////
+		std::size_t _count;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a sample to a ring buffer, the oldest one is overwritten once it is
+		//   full, any thread may add at the same time
+		// @param1: the ring buffer
+		// @param2: the sample
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _add(nring& ring, nsample const& sample) -> void
+		{
+			auto position = ring._claimed.fetch_add(1, std::memory_order_relaxed);
+			nslot& slot = ring._slots[position % ring._slots.size()];
+			slot._sequence.store(0, std::memory_order_relaxed);
+			slot._phase.store(static_cast<int>(sample._phase), std::memory_order_release); // a reader of a new value sees the 0 as well
+			slot._frame.store(sample._frame, std::memory_order_release);
+			slot._start.store(sample._start, std::memory_order_release);
+			slot._time.store(sample._time, std::memory_order_release);
+			slot._sequence.store(position + 1, std::memory_order_release);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! copies the samples of a ring buffer since the last clr(), oldest first
+		// ! a slot that is written or overwritten while it is copied is skipped
+		// @param1: the ring buffer
+		// @param2: filled with the samples
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get(nring const& ring, std::vector<nsample>& samples) -> void
+		{
+			samples.clear();
+			unsigned long long end = ring._claimed.load(std::memory_order_acquire);
+			unsigned long long begin = (end > ring._slots.size()) ? (end - ring._slots.size()) : 0;
+			begin = std::max(begin, ring._cleared.load(std::memory_order_relaxed));
+			for(unsigned long long position = begin; position < end; position++)
+			{
+				nslot const& slot = ring._slots[position % ring._slots.size()];
+				if(slot._sequence.load(std::memory_order_acquire) != (position + 1))
+					continue;
+				nsample sample;
+				sample._phase = static_cast<nphase>(slot._phase.load(std::memory_order_acquire));
+				sample._frame = slot._frame.load(std::memory_order_acquire);
+				sample._start = slot._start.load(std::memory_order_acquire);
+				sample._time = slot._time.load(std::memory_order_acquire);
+				if(slot._sequence.load(std::memory_order_relaxed) == (position + 1))
+					samples.push_back(sample);
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! takes the percentiles of recorded times
+		// @param1: the times, they are sorted
+		// @return: the percentiles, all 0 if there are no times
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_stats(std::vector<unsigned long long>& times) -> nphase_stats
+		{
+			nphase_stats stats;
+			stats._calls = times.size();
+			stats._p50 = 0;
+			stats._p90 = 0;
+			stats._p99 = 0;
+			stats._max = 0;
+			if(times.empty())
+			{
+				return stats;
+			}
+			std::sort(times.begin(), times.end());
+			stats._p50 = times[((times.size() - 1) * 50) / 100];
+			stats._p90 = times[((times.size() - 1) * 90) / 100];
+			stats._p99 = times[((times.size() - 1) * 99) / 100];
+			stats._max = times.back();
+			return stats;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the nanoseconds of a time as the three fraction digits of its
+		//   microseconds
+		// @param1: the time in nanoseconds
+		// @return: the fraction digits
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _get_fraction(unsigned long long time) -> std::string
+		{
+			std::string fraction = std::to_string(time % 1000);
+			return (std::string(3 - fraction.size(), '0') + fraction);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! writes a string escaped for json
+		// @param1: the stream to write to
+		// @param2: the string
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _dump_string(std::ostream& stream, std::string const& text) -> void
+		{
+			for(auto character : text)
+			{
+				if((character == '"') || (character == '\\'))
+					stream << '\\';
+				if(static_cast<unsigned char>(character) >= 0x20)
+					stream << character;
+			}
+		}
+}; // end of class nprofiler
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! records the time until it is destroyed into a nprofiler
+/////////////////////////////////////////////////////////////////////////////////
+class nprofile_timer
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nprofile_timer(const nprofile_timer&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nprofile_timer& operator=(const nprofile_timer&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: starts the timer
+		// @param1: the nprofiler to record into
+		// @param2: the index of the profile
+		// @param3: the timed phase
+		/////////////////////////////////////////////////////////////////////////////////
+		nprofile_timer(nprofiler& profiler, std::size_t profile, nphase phase)
+			: _profiler(profiler)
+			, _profile(profile)
+			, _phase(phase)
+			, _start(std::chrono::steady_clock::now())
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom destructor: records the time
+		/////////////////////////////////////////////////////////////////////////////////
+		~nprofile_timer()
+		{
+			_profiler.record(_profile, _phase, _start, std::chrono::steady_clock::now());
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the nprofiler to record into
+		/////////////////////////////////////////////////////////////////////////////////
+		nprofiler& _profiler;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the index of the profile
+		/////////////////////////////////////////////////////////////////////////////////
+		const std::size_t _profile;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the timed phase
+		/////////////////////////////////////////////////////////////////////////////////
+		const nphase _phase;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! when the timer started
+		/////////////////////////////////////////////////////////////////////////////////
+		const std::chrono::steady_clock::time_point _start;
+}; // end of class nprofile_timer
+
+} // end of namespace nstate_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NSTATE_MANAGER__NPROFILER__
@@ -28,9 +28,19 @@
 
 /////////////////////////////////////////////////////////////////////////////////
 // ! memory for shared pointers
-// ! SFML/Graphics.hpp for Drawable
+// ! vector for the blob of a suspended state
+// ! string and typeinfo for the name of the state
+// ! cxxabi.h and cstdlib for demangling the name of the state with gcc
+// ! SFML/Graphics.hpp for Drawable and RenderTarget
 /////////////////////////////////////////////////////////////////////////////////
 #include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
 #include <SFML/Graphics.hpp>
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -79,6 +89,74 @@ class nstate
 		// ! used to unset internal pause variable
 		/////////////////////////////////////////////////////////////////////////////////
 		virtual void resume() = 0;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! virtual preload function that may be implemented in a derived class
+		// ! called by nstate_manager::add() before the state is pushed, used to start
+		//   loading resources in the background while the current state keeps running
+		/////////////////////////////////////////////////////////////////////////////////
+		virtual void preload() {}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! virtual ready function that may be implemented in a derived class
+		// ! nstate_manager::process() only pushes the state once it is ready
+		// @return: indicator if everything started by preload() is done
+		/////////////////////////////////////////////////////////////////////////////////
+		virtual bool ready() {return true;}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! virtual prepare function that may be implemented in a derived class
+		// ! called by nstate_manager::add_async() on a worker thread while the current
+		//   state keeps running, used to build everything init() would stall the frame
+		//   loop with
+		// ! runs outside the render thread, so it must not draw or touch the window
+		/////////////////////////////////////////////////////////////////////////////////
+		virtual void prepare() {}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! virtual capture function that may be implemented in a derived class
+		// ! called by nstate_manager::process() right before the state is paused, used
+		//   to draw the current frame into the cached frame of the state, without
+		//   clearing or displaying the target
+		// @param1: the cached frame to draw into
+		/////////////////////////////////////////////////////////////////////////////////
+		virtual void capture(sf::RenderTarget&) {}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! virtual suspend function that may be implemented in a derived class
+		// ! called by nstate_manager::process() on a paused state deep enough in the
+		//   stack, used to write the minimal state into param1 and to drop every
+		//   resource reference so nresource_manager::clr_unused() can reclaim them
+		// @param1: the empty blob to write into, see nblob_writer
+		// @return: false if the state can not be suspended and keeps everything
+		/////////////////////////////////////////////////////////////////////////////////
+		virtual bool suspend(std::vector<char>&) {return false;}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! virtual restore function that may be implemented in a derived class
+		// ! called by nstate_manager::process() before a suspended state is resumed,
+		//   after preload() was called again and ready() returned true, used to
+		//   rebuild the state from the blob written by suspend()
+		// @param1: the blob written by suspend(), see nblob_reader
+		/////////////////////////////////////////////////////////////////////////////////
+		virtual void restore(std::vector<char> const&) {}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! virtual get_name function that may be implemented in a derived class
+		// ! used by the nprofiler of the nstate_manager to tell the states apart
+		// @return: the name of the state, the type name of the derived class by default
+		/////////////////////////////////////////////////////////////////////////////////
+		virtual std::string get_name() const
+		{
+#ifdef __GNUC__
+			int status = 0;
+			char* demangled = abi::__cxa_demangle(typeid(*this).name(), nullptr, nullptr, &status);
+			if((status == 0) && (demangled != nullptr))
+			{
+				std::string name(demangled);
+				std::free(demangled);
+				return name;
+			}
+#endif
+			return typeid(*this).name();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! virtual destructor so derived states are destroyed completely
+		/////////////////////////////////////////////////////////////////////////////////
+		virtual ~nstate() {}
 	private:
 }; // end of class nstate
 
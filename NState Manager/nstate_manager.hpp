@@ -27,15 +27,33 @@
 #define __NENGINE__NSTATE_MANAGER__NSTATE_MANAGER__
 
 /////////////////////////////////////////////////////////////////////////////////
+// ! atomic for the lock-free transition queue
+// ! chrono for polling the background preparation
+// ! deque for the transitions waiting for their state
+// ! future for the background preparation
 // ! memory for shared pointers
 // ! mutex for thread safety
-// ! stack for the state stack
+// ! ostream for writing the trace
+// ! vector for the state stack, the suspended states and the profile stats
 // ! nstate for managing different states
+// ! ntransition for the queued changes to the state stack
+// ! nprofiler for timing the states
+// ! nblob for the states writing their blob when they are suspended
+// ! SFML/Graphics.hpp for the cached frames of the paused states
 /////////////////////////////////////////////////////////////////////////////////
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
 #include <memory>
 #include <mutex>
-#include <stack>
+#include <ostream>
+#include <vector>
 #include "nstate.hpp"
+#include "ntransition.hpp"
+#include "nprofiler.hpp"
+#include "nblob.hpp"
+#include <SFML/Graphics.hpp>
 
 /////////////////////////////////////////////////////////////////////////////////
 // ! namespace for the nengine
@@ -53,8 +71,32 @@ namespace nstate_manager {
 using namespace nengine;
 using namespace nengine::nstate_manager;
 
+/////////////////////////////////////////////////////////////////////////////////
+// ! a single state on the stack of a nstate_manager
+// ! _suspended: if the state wrote itself into _blob and released its resources
+// ! _restoring: if the preload() of the suspended state was started again
+// ! _blob: the state written by nstate::suspend()
+// ! _frame: the cached frame of the paused state, nullptr if the cache was
+//   disabled or the frame was released by the suspension
+// ! _profiled: if _profile was looked up, the first time the state is timed
+// ! _profile: the index of the profile of the state in the nprofiler
+/////////////////////////////////////////////////////////////////////////////////
+struct nstate_slot
+{
+	std::unique_ptr<nstate> _state;
+	bool _suspended;
+	bool _restoring;
+	std::vector<char> _blob;
+	std::unique_ptr<sf::RenderTexture> _frame;
+	bool _profiled;
+	std::size_t _profile;
+};
+
 /////////////////////////////////////////////////////////////////////////////////
 // ! the nstate_manager
+// ! add(), add_async(), reset(), remove() and clr() only queue a transition
+//   without locking, so any thread can request one, process() applies them in
+//   order
 /////////////////////////////////////////////////////////////////////////////////
 class nstate_manager
 {
@@ -73,10 +115,11 @@ class nstate_manager
 		nstate_manager()
 			: _mutex()
 			, _states()
-			, _state()
-			, _removing(false)
-			, _adding(false)
-			, _replacing(false)
+			, _queue(nullptr)
+			, _pending()
+			, _frame_size(0, 0)
+			, _suspend_depth(0)
+			, _profiler()
 		{
 		}
 		/////////////////////////////////////////////////////////////////////////////////
@@ -86,142 +129,523 @@ class nstate_manager
 		{
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				while(!_states.empty())
-					_states.pop();
+				_take();
+				_pending.clear();
+				_states.clear();
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! adds a state
+		// ! the preload of the state starts right away, the state is pushed by the
+		//   first process() after it is ready, or by the next one if there is no
+		//   state to keep running in the meantime
+		// ! later transitions wait until the state is pushed
 		// @param1: the state to add
 		// @param2: to indicate if the state is replacing the current state
 		/////////////////////////////////////////////////////////////////////////////////
 		auto add(std::unique_ptr<nstate> state, bool replacing) -> void
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
-			{ // locked area
-				_adding = true;
-				_replacing = replacing;
-				_state = std::move(state);
-			} // lock freed
+			state->preload();
+			_push((replacing ? ntransition_type::REPLACE : ntransition_type::PUSH), std::move(state), false);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a state that is prepared in the background
+		// ! like add(), but the prepare() of the state runs on a worker thread as well,
+		//   the state is pushed by the first process() after it is prepared and ready
+		// ! an exception thrown by prepare() is rethrown by that process()
+		// @param1: the state to add
+		// @param2: to indicate if the state is replacing the current state
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_async(std::unique_ptr<nstate> state, bool replacing) -> void
+		{
+			state->preload();
+			_push((replacing ? ntransition_type::REPLACE : ntransition_type::PUSH), std::move(state), true);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! removes a state
 		/////////////////////////////////////////////////////////////////////////////////
 		auto remove() -> void
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
-			{ // locked area
-				_removing = true;
-			} // lock freed
+			_push(ntransition_type::POP, nullptr, false);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! removes every state
+		/////////////////////////////////////////////////////////////////////////////////
+		auto clr() -> void
+		{
+			_push(ntransition_type::CLEAR, nullptr, false);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! removes every state and adds a new one
+		// ! like add(), the current state keeps running until the new one is ready,
+		//   the states below are removed without being resumed
+		// @param1: the state to add
+		/////////////////////////////////////////////////////////////////////////////////
+		auto reset(std::unique_ptr<nstate> state) -> void
+		{
+			state->preload();
+			_push(ntransition_type::RESET, std::move(state), false);
 		}
 		/////////////////////////////////////////////////////////////////////////////////
 		// ! processes all changes made to the nstate_manager with add() && remove()
 		/////////////////////////////////////////////////////////////////////////////////
 		auto process() -> void
 		{
+			report_process();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! processes all changes made to the nstate_manager with add() && remove()
+		// @return: true if a state was removed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto if_process() -> bool
+		{
+			return (report_process()._removed > 0);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! processes all changes made to the nstate_manager in the order they were
+		//   requested, a transition whose state is not ready yet holds back the
+		//   later ones
+		// @return: the amount of pushed and removed states and of waiting transitions
+		/////////////////////////////////////////////////////////////////////////////////
+		auto report_process() -> ntransition_report
+		{
+			ntransition_report report;
+			report._pushed = 0;
+			report._removed = 0;
+			report._pending = 0;
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				if((_removing) && (!_states.empty()))
+				_take();
+				while(!_pending.empty())
 				{
-					_states.pop();
-					if(!_states.empty())
+					ntransition& transition = *_pending.front();
+					if((transition._state != nullptr) && (!_states.empty()) && ((!_is_prepared(transition)) || (!transition._state->ready())))
 					{
-						_states.top()->resume();
+						break;
 					}
-					_removing = false;
-				}
-				if(_adding)
-				{
-					if(!_states.empty())
+					if((transition._type == ntransition_type::POP) && (!_is_restored()))
 					{
-						if(_replacing)
-						{
-							_states.pop();
-						}
-						else
-						{
-							_states.top()->pause();
-						}
+						break;
 					}
-					_states.push(std::move(_state));
-					_states.top()->init();
-					_adding = false;
+					_apply(transition, report);
+					_pending.pop_front();
 				}
+				report._pending = _pending.size();
 			} // lock freed
+			return report;
 		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! processes all changes made to the nstate_manager with add() && remove()
-		// @return: true if a state was removed
+		// ! returns the current state
+		// ! the state does not move when the stack grows, the pointer stays valid
+		//   until a process() removes the state, so it is used on the thread calling
+		//   process()
+		// @return: a pointer to the current state, nullptr if there is none
 		/////////////////////////////////////////////////////////////////////////////////
-		auto if_process() -> bool
+		auto get() -> nstate*
 		{
-			bool clr = false;
 			std::unique_lock<std::mutex> lock(_mutex);
 			{ // locked area
-				if((_removing) && (!_states.empty()))
+				if(_states.empty())
 				{
-					clr = true;
-					_states.pop();
-					if(!_states.empty())
-					{
-						_states.top()->resume();
-					}
-					_removing = false;
+					return nullptr;
+				}
+				return _states.back()._state.get();
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! calls handle() of the current state, timed if the profiling is enabled
+		/////////////////////////////////////////////////////////////////////////////////
+		auto handle() -> void
+		{
+			if(!_profiler.is_enabled())
+			{
+				get()->handle();
+				return;
+			}
+			std::size_t profile = 0;
+			nstate& state = *_get_profiled(profile);
+			nprofile_timer timer(_profiler, profile, nphase::HANDLE);
+			state.handle();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! calls update() of the current state, timed if the profiling is enabled
+		// @param1: the fixed step in seconds
+		/////////////////////////////////////////////////////////////////////////////////
+		auto update(float dt) -> void
+		{
+			if(!_profiler.is_enabled())
+			{
+				get()->update(dt);
+				return;
+			}
+			std::size_t profile = 0;
+			nstate& state = *_get_profiled(profile);
+			nprofile_timer timer(_profiler, profile, nphase::UPDATE);
+			state.update(dt);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! calls draw() of the current state, timed if the profiling is enabled
+		// @param1: the time since the last update() in seconds
+		/////////////////////////////////////////////////////////////////////////////////
+		auto draw(float dt) -> void
+		{
+			if(!_profiler.is_enabled())
+			{
+				get()->draw(dt);
+				return;
+			}
+			std::size_t profile = 0;
+			nstate& state = *_get_profiled(profile);
+			nprofile_timer timer(_profiler, profile, nphase::DRAW);
+			state.draw(dt);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! enables or disables timing handle(), update() and draw(), disabled by
+		//   default
+		// @param1: indicator if the states are timed
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_profiling(bool enabled) -> void
+		{
+			_profiler.set_enabled(enabled);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the percentiles of the phases and frames of every timed state
+		// @return: the stats in the order the states were timed first
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_profile_stats() -> std::vector<nprofile_stats>
+		{
+			return _profiler.get_stats();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! writes the timed calls of the last frames as a Chrome trace
+		// @param1: the stream to write to
+		// @param2: the amount of frames
+		/////////////////////////////////////////////////////////////////////////////////
+		auto dump_trace(std::ostream& stream, unsigned int frames) -> void
+		{
+			_profiler.dump_trace(stream, frames);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! enables suspending deeply paused states
+		// ! a paused state at least param1 states below the current one is asked to
+		//   suspend(), it is restored before it is the current state again
+		// @param1: the depth, 1 for every paused state, 0 disables the suspension
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_suspend_depth(unsigned int depth) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_suspend_depth = depth;
+				_suspend();
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! enables caching the last frame of every paused state
+		// ! a state added without replacing the current one draws the frame of the
+		//   paused state with draw_frame() instead of drawing that state again
+		// @param1: the size of the cached frames, usually the window size, (0, 0)
+		//          disables the cache
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_frame_cache(sf::Vector2u const& size) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_frame_size = size;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! draws the cached frame of the paused state below the current state
+		// @param1: the target to draw on
+		// @return: false if there is no cached frame
+		/////////////////////////////////////////////////////////////////////////////////
+		auto draw_frame(sf::RenderTarget& target) -> bool
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if((_states.size() < 2) || (_states[_states.size() - 2]._frame == nullptr))
+				{
+					return false;
 				}
-				if(_adding)
+				target.draw(sf::Sprite(_states[_states.size() - 2]._frame->getTexture()));
+			} // lock freed
+			return true;
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety of the state stack
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! all states
+		/////////////////////////////////////////////////////////////////////////////////
+		std::vector<nstate_slot> _states;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the lock-free stack of requested transitions, newest first
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<ntransition*> _queue;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the taken transitions in the order they were requested, the first one is
+		//   waiting for its state
+		/////////////////////////////////////////////////////////////////////////////////
+		std::deque<std::unique_ptr<ntransition>> _pending;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the size of the cached frames, (0, 0) if the cache is disabled
+		/////////////////////////////////////////////////////////////////////////////////
+		sf::Vector2u _frame_size;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the depth from which on paused states are suspended, 0 if disabled
+		/////////////////////////////////////////////////////////////////////////////////
+		unsigned int _suspend_depth;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the timings of the states
+		/////////////////////////////////////////////////////////////////////////////////
+		nprofiler _profiler;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! queues a transition without locking
+		// @param1: the kind of transition
+		// @param2: the state to push, nullptr for POP and CLEAR
+		// @param3: to indicate if the prepare() of param2 runs on a worker thread
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _push(ntransition_type type, std::unique_ptr<nstate> state, bool async) -> void
+		{
+			ntransition* transition = new ntransition();
+			transition->_type = type;
+			transition->_state = std::move(state);
+			if(async)
+			{
+				nstate* prepared = transition->_state.get();
+				transition->_prepared = std::async(std::launch::async, [prepared]()
 				{
-					if(!_states.empty())
+					prepared->prepare();
+				});
+			}
+			transition->_next = _queue.load(std::memory_order_relaxed);
+			while(!_queue.compare_exchange_weak(transition->_next, transition, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! takes every queued transition and appends it to the pending ones in the
+		//   order they were requested, must be locked
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _take() -> void
+		{
+			ntransition* transition = _queue.exchange(nullptr, std::memory_order_acquire);
+			ntransition* ordered = nullptr;
+			while(transition != nullptr)
+			{
+				ntransition* next = transition->_next;
+				transition->_next = ordered;
+				ordered = transition;
+				transition = next;
+			}
+			while(ordered != nullptr)
+			{
+				ntransition* next = ordered->_next;
+				ordered->_next = nullptr;
+				_pending.push_back(std::unique_ptr<ntransition>(ordered));
+				ordered = next;
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! applies a single transition to the state stack, must be locked
+		// ! rethrows an exception thrown by prepare(), the transition is dropped
+		// @param1: the transition
+		// @param2: the report to count the changes in
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _apply(ntransition& transition, ntransition_report& report) -> void
+		{
+			switch(transition._type)
+			{
+				case ntransition_type::POP:
+					_pop(report);
+					break;
+				case ntransition_type::CLEAR:
+					_clr(report);
+					break;
+				case ntransition_type::PUSH:
+				case ntransition_type::REPLACE:
+				case ntransition_type::RESET:
+					if(transition._prepared.valid())
+					{
+						try
+						{
+							transition._prepared.get();
+						}
+						catch(...)
+						{
+							_pending.pop_front();
+							throw;
+						}
+					}
+					if(transition._type == ntransition_type::RESET)
+					{
+						_clr(report);
+					}
+					else if(!_states.empty())
 					{
-						if(_replacing)
+						if(transition._type == ntransition_type::REPLACE)
 						{
-							clr = true;
-							_states.pop();
+							_states.pop_back();
+							report._removed++;
 						}
 						else
 						{
-							_states.top()->pause();
+							_states.back()._frame = _capture(*_states.back()._state);
+							_states.back()._state->pause();
 						}
 					}
-					_states.push(std::move(_state));
-					_states.top()->init();
-					_adding = false;
-				}
-			} // lock freed
-			return clr;
+					_states.push_back(nstate_slot());
+					_states.back()._state = std::move(transition._state);
+					_states.back()._suspended = false;
+					_states.back()._restoring = false;
+					_states.back()._profiled = false;
+					_states.back()._profile = 0;
+					_states.back()._state->init();
+					report._pushed++;
+					_suspend();
+					break;
+			}
 		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! returns the current state
-		// @return: a unique pointer to the current state
+		// ! removes the current state and resumes the one below, must be locked
+		// @param1: the report to count the change in
 		/////////////////////////////////////////////////////////////////////////////////
-		auto get() -> std::unique_ptr<nstate>&
+		auto _pop(ntransition_report& report) -> void
 		{
-			return _states.top();
+			if(_states.empty())
+			{
+				return;
+			}
+			_states.pop_back();
+			report._removed++;
+			if(!_states.empty())
+			{
+				nstate_slot& slot = _states.back();
+				if(slot._suspended)
+				{
+					slot._state->restore(slot._blob);
+					slot._blob.clear();
+					slot._blob.shrink_to_fit();
+					slot._suspended = false;
+					slot._restoring = false;
+				}
+				slot._frame.reset();
+				slot._state->resume();
+			}
 		}
-	private:
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! for thread safety
+		// ! removes every state without resuming one, must be locked
+		// @param1: the report to count the changes in
 		/////////////////////////////////////////////////////////////////////////////////
-		std::mutex _mutex;
+		auto _clr(ntransition_report& report) -> void
+		{
+			report._removed += _states.size();
+			_states.clear();
+		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! all states
+		// ! draws the current frame of a state that is going to be paused, must be
+		//   locked
+		// @param1: the state
+		// @return: the cached frame, nullptr if the cache is disabled or the render
+		//          texture could not be created
 		/////////////////////////////////////////////////////////////////////////////////
-		std::stack<std::unique_ptr<nstate>> _states;
+		auto _capture(nstate& state) -> std::unique_ptr<sf::RenderTexture>
+		{
+			std::unique_ptr<sf::RenderTexture> frame;
+			if((_frame_size.x == 0) || (_frame_size.y == 0))
+			{
+				return frame;
+			}
+			frame.reset(new sf::RenderTexture());
+			if(!frame->create(_frame_size.x, _frame_size.y))
+			{
+				frame.reset();
+				return frame;
+			}
+			frame->clear(sf::Color::Black);
+			state.capture(*frame);
+			frame->display();
+			return frame;
+		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! last state
+		// ! suspends every paused state at least _suspend_depth states below the
+		//   current one, a state that does not support it is kept, must be locked
+		// ! a suspended state releases its cached frame as well, unless draw_frame()
+		//   still draws it right below the current state
 		/////////////////////////////////////////////////////////////////////////////////
-		std::unique_ptr<nstate> _state;
+		auto _suspend() -> void
+		{
+			if((_suspend_depth == 0) || (_states.size() <= _suspend_depth))
+			{
+				return;
+			}
+			for(std::size_t i = 0; i < (_states.size() - _suspend_depth); i++)
+			{
+				nstate_slot& slot = _states[i];
+				if(!slot._suspended)
+				{
+					slot._blob.clear();
+					slot._suspended = slot._state->suspend(slot._blob);
+				}
+				if(slot._suspended && ((i + 2) < _states.size()))
+				{
+					slot._frame.reset();
+				}
+			}
+		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! if you are removing a state
+		// ! to find out if the state below the current one can be resumed, starts
+		//   the preload() of a suspended one, must be locked
+		// @return: true if it is not suspended or its resources are ready
 		/////////////////////////////////////////////////////////////////////////////////
-		bool _removing;
+		auto _is_restored() -> bool
+		{
+			if(_states.size() < 2)
+			{
+				return true;
+			}
+			nstate_slot& slot = _states[_states.size() - 2];
+			if(!slot._suspended)
+			{
+				return true;
+			}
+			if(!slot._restoring)
+			{
+				slot._state->preload();
+				slot._restoring = true;
+			}
+			return slot._state->ready();
+		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! if you are adding a state
+		// ! to get the current state with its profile index, the index is looked up
+		//   by name the first time the state is timed and kept in its slot
+		// @param1: filled with the profile index
+		// @return: the current state
 		/////////////////////////////////////////////////////////////////////////////////
-		bool _adding;
+		auto _get_profiled(std::size_t& profile) -> nstate*
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				nstate_slot& slot = _states.back();
+				if(!slot._profiled)
+				{
+					slot._profile = _profiler.get_profile(slot._state->get_name());
+					slot._profiled = true;
+				}
+				profile = slot._profile;
+				return slot._state.get();
+			} // lock freed
+		}
 		/////////////////////////////////////////////////////////////////////////////////
-		// ! if new state is replacing the old one
+		// ! to find out if the prepare() of a transition is done, must be locked
+		// @param1: the transition
+		// @return: true if it is done or there is none
 		/////////////////////////////////////////////////////////////////////////////////
-		bool _replacing;
+		auto _is_prepared(ntransition const& transition) -> bool
+		{
+			return (!transition._prepared.valid() || (transition._prepared.wait_for(std::chrono::seconds(0)) == std::future_status::ready));
+		}
 }; // end of class nstate_manager
 
 } // end of namespace nstate_manager
@@ -229,4 +653,3 @@ class nstate_manager
 } // end of namespace nengine
 
 #endif // end of __NENGINE__NSTATE_MANAGER__NSTATE_MANAGER__
-
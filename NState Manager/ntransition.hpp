@@ -0,0 +1,106 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NSTATE_MANAGER__NTRANSITION__
+#define __NENGINE__NSTATE_MANAGER__NTRANSITION__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! future for the background preparation
+// ! memory for unique pointers
+// ! nstate for the added states
+/////////////////////////////////////////////////////////////////////////////////
+#include <future>
+#include <memory>
+#include "nstate.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nstate_manager
+/////////////////////////////////////////////////////////////////////////////////
+namespace nstate_manager {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the kinds of changes to the state stack
+// ! PUSH: pauses the current state and pushes a new one
+// ! POP: removes the current state and resumes the one below
+// ! REPLACE: removes the current state and pushes a new one
+// ! CLEAR: removes every state
+// ! RESET: removes every state and pushes a new one
+/////////////////////////////////////////////////////////////////////////////////
+enum class ntransition_type
+{
+	PUSH,
+	POP,
+	REPLACE,
+	CLEAR,
+	RESET
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a single requested change to the state stack, queued by nstate_manager
+// ! _state: the state to push, empty for POP and CLEAR
+// ! _prepared: the running prepare() of _state, invalid if there is none
+// ! _next: the next older request while it is queued
+/////////////////////////////////////////////////////////////////////////////////
+struct ntransition
+{
+	ntransition_type _type;
+	std::unique_ptr<nstate> _state;
+	std::future<void> _prepared;
+	ntransition* _next;
+	/////////////////////////////////////////////////////////////////////////////////
+	// ! custom destructor: the worker still uses the state until prepare() returns
+	/////////////////////////////////////////////////////////////////////////////////
+	~ntransition()
+	{
+		if(_prepared.valid())
+		{
+			_prepared.wait();
+		}
+	}
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! struct ntransition_report to report what a nstate_manager::process() changed
+// ! _pushed: states pushed by PUSH, REPLACE and RESET
+// ! _removed: states removed by POP, REPLACE, CLEAR and RESET
+// ! _pending: requests still waiting for their state to be ready
+/////////////////////////////////////////////////////////////////////////////////
+struct ntransition_report
+{
+	unsigned int _pushed;
+	unsigned int _removed;
+	unsigned int _pending;
+};
+
+} // end of namespace nstate_manager
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NSTATE_MANAGER__NTRANSITION__
@@ -1,32 +1,474 @@
 #include "../nstate_manager.hpp"
 #include "../nstate.hpp"
+#include <SFML/Graphics.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <iostream>
-#include <SFML/Graphics.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
-int main()
+/////////////////////////////////////////////////////////////////////////////////
+// ! headless test: the states only record what the nstate_manager calls, no
+//   window is opened
+/////////////////////////////////////////////////////////////////////////////////
+using nengine::nstate_manager::nstate;
+using nengine::nstate_manager::nstate_manager;
+using nengine::nstate_manager::ntransition_report;
+
+int failed = 0;
+
+void check(bool condition, char const* name)
+{
+	std::cout << (condition ? "ok      " : "FAILED  ") << name << std::endl;
+	if(!condition)
+		failed++;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a state that records the calls of the nstate_manager
+// ! prepare() waits for _gate if it is valid and throws if _failing is set
+// ! the destructor leaves the calls in _removed if it is set
+// ! suspend() writes the id, the calls and a literal if _suspendable is set,
+//   restore() sets _restored if it reads them back
+/////////////////////////////////////////////////////////////////////////////////
+class ntest_state : public nstate
+{
+	public:
+		ntest_state(int id)
+			: _id(id)
+			, _calls()
+			, _gate()
+			, _failing(false)
+			, _ready(true)
+			, _prepared(false)
+			, _prepared_by()
+			, _init_by()
+			, _removed(nullptr)
+			, _suspendable(false)
+			, _restored(false)
+		{
+		}
+		~ntest_state()
+		{
+			if(_removed != nullptr)
+				*_removed = _calls;
+		}
+		void init() {_calls += "i"; _init_by = std::this_thread::get_id();}
+		void handle() {_calls += "h";}
+		void update(float) {_calls += "u";}
+		void draw(float) {_calls += "d";}
+		void pause() {_calls += "p";}
+		void resume() {_calls += "r";}
+		bool ready() {return _ready;}
+		void capture(sf::RenderTarget&) {_calls += "c";}
+		bool suspend(std::vector<char>& blob)
+		{
+			if(!_suspendable)
+				return false;
+			nengine::nstate_manager::nblob_writer(blob).write(_id).write(_calls).write("level");
+			_calls += "s";
+			return true;
+		}
+		void restore(std::vector<char> const& blob)
+		{
+			nengine::nstate_manager::nblob_reader reader(blob);
+			int id = 0;
+			std::string calls;
+			std::string level;
+			_restored = reader.read(id) && reader.read(calls) && reader.read(level) && (id == _id) && ((calls + "s") == _calls) && (level == "level") && (!reader.read(id));
+			_calls += "R";
+		}
+		void prepare()
+		{
+			_prepared_by = std::this_thread::get_id();
+			if(_gate.valid())
+				_gate.wait();
+			if(_failing)
+				throw std::string("prepare failed");
+			_prepared = true;
+		}
+		int _id;
+		std::string _calls;
+		std::shared_future<void> _gate;
+		bool _failing;
+		std::atomic<bool> _ready;
+		std::atomic<bool> _prepared;
+		std::thread::id _prepared_by;
+		std::thread::id _init_by;
+		std::string* _removed;
+		bool _suspendable;
+		bool _restored;
+};
+
+int get_id(nstate_manager& manager)
+{
+	return static_cast<ntest_state&>(*manager.get())._id;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! add_async(): prepare() runs on a worker while the current state keeps
+//   running, the state is pushed by the first process() after it is prepared
+//   and ready, init() runs on the calling thread
+/////////////////////////////////////////////////////////////////////////////////
+void test_async_add()
+{
+	nstate_manager manager;
+	manager.add(std::unique_ptr<nstate>(new ntest_state(1)), true);
+	manager.process();
+
+	std::promise<void> gate;
+	ntest_state* next = new ntest_state(2);
+	next->_gate = gate.get_future().share();
+	auto start = std::chrono::steady_clock::now();
+	manager.add_async(std::unique_ptr<nstate>(next), true);
+	double add_ms = elapsed_ms(start);
+
+	ntransition_report report = manager.report_process();
+	check((report._pushed == 0) && (report._pending == 1) && (get_id(manager) == 1), "async: the current state keeps running while preparing");
+	manager.update(0.f);
+	check(static_cast<ntest_state&>(*manager.get())._calls == "iu", "async: the current state is updated meanwhile");
+
+	next->_ready = false;
+	gate.set_value();
+	while(!next->_prepared)
+		std::this_thread::yield();
+	// the worker sets _prepared right before the future becomes ready
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	report = manager.report_process();
+	check((report._pushed == 0) && (report._pending == 1), "async: a prepared state waits until it is ready");
+
+	next->_ready = true;
+	double process_ms = 0;
+	do
+	{
+		start = std::chrono::steady_clock::now();
+		report = manager.report_process();
+		process_ms = elapsed_ms(start);
+	} while(report._pending > 0);
+	std::cout << "        add_async " << add_ms << " ms, pushing process() " << process_ms << " ms" << std::endl;
+	check((report._pushed == 1) && (report._removed == 1) && (report._pending == 0) && (get_id(manager) == 2), "async: pushed once prepared and ready");
+	check(next->_prepared_by != std::this_thread::get_id(), "async: prepare() ran on a worker thread");
+	check(next->_init_by == std::this_thread::get_id(), "async: init() ran on the calling thread");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! add_async(): later transitions wait for the prepared state, an exception of
+//   prepare() is rethrown by process() and only drops its own transition
+/////////////////////////////////////////////////////////////////////////////////
+void test_async_order()
 {
-	sf::RenderWindow window(sf::VideoMode(960, 540), "State Manager Test");
-	
-	nengine::nstate_manager::nstate_manager state_manager;
-	
-	nengine::nstate_manager::nstate state;
-	
-	state_manager.push(state);
-	
-    while (window.isOpen())
-    {
-        sf::Event event;
-        while (window.pollEvent(event))
-        {
-        	state_manager.get()->handle(event);
-        }
-        state_manager.get()->update();
-        window.clear(sf::Color::Black);
-        window.draw(*state_manager.get());
-        window.display();
-    }
-	
-	return 0;
+	nstate_manager manager;
+	manager.add(std::unique_ptr<nstate>(new ntest_state(1)), true);
+	manager.process();
+
+	std::promise<void> gate;
+	ntest_state* slow = new ntest_state(2);
+	slow->_gate = gate.get_future().share();
+	manager.add_async(std::unique_ptr<nstate>(slow), false);
+	manager.add(std::unique_ptr<nstate>(new ntest_state(3)), false);
+	ntransition_report report = manager.report_process();
+	check((report._pushed == 0) && (report._pending == 2), "async order: a later add waits for the prepared state");
+	gate.set_value();
+	while(manager.report_process()._pending > 0)
+		std::this_thread::yield();
+	check((get_id(manager) == 3) && (slow->_calls == "ip"), "async order: both pushed in the requested order");
+
+	ntest_state* failing = new ntest_state(4);
+	failing->_failing = true;
+	manager.add_async(std::unique_ptr<nstate>(failing), true);
+	manager.remove();
+	bool caught = false;
+	try
+	{
+		while(manager.report_process()._pending > 0)
+			std::this_thread::yield();
+	}
+	catch(std::string const&)
+	{
+		caught = true;
+	}
+	check(caught, "async order: the exception of prepare() is rethrown");
+	check(get_id(manager) == 3, "async order: the failed state is not pushed");
+	report = manager.report_process();
+	check((report._removed == 1) && (report._pending == 0) && (get_id(manager) == 2), "async order: the transitions after it are still applied");
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+// ! set_frame_cache(): a state paused by an overlay draws its frame once into
+//   the cache, the overlay draws it with draw_frame() until the state resumes
+/////////////////////////////////////////////////////////////////////////////////
+void test_frame_cache()
+{
+	nstate_manager manager;
+	sf::RenderTexture target;
+	target.create(8, 8);
+	ntest_state* game = new ntest_state(1);
+	manager.add(std::unique_ptr<nstate>(game), true);
+	manager.add(std::unique_ptr<nstate>(new ntest_state(2)), false);
+	manager.process();
+	check(game->_calls == "ip", "frame cache: disabled by default");
+	check(!manager.draw_frame(target), "frame cache: no frame without the cache");
+
+	manager.set_frame_cache(sf::Vector2u(8, 8));
+	ntest_state* menu = static_cast<ntest_state*>(manager.get());
+	manager.add(std::unique_ptr<nstate>(new ntest_state(3)), false);
+	manager.process();
+	check(menu->_calls == "icp", "frame cache: the paused state is captured once before it is paused");
+	check(manager.draw_frame(target), "frame cache: the overlay draws the cached frame");
+	manager.draw(0.f);
+	check(menu->_calls == "icp", "frame cache: the paused state is not drawn again");
+
+	manager.add(std::unique_ptr<nstate>(new ntest_state(4)), true);
+	manager.process();
+	check((menu->_calls == "icp") && manager.draw_frame(target), "frame cache: replacing the overlay keeps the frame below it");
+
+	manager.remove();
+	manager.process();
+	check((get_id(manager) == 2) && (menu->_calls == "icpr"), "frame cache: the captured state resumes");
+	check(!manager.draw_frame(target), "frame cache: its frame is dropped, the state below was paused without the cache");
+
+	manager.clr();
+	manager.process();
+	check(!manager.draw_frame(target), "frame cache: cleared with the states");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! get(): the pointer stays valid while the stack grows, reset(): the states
+//   below are removed without being resumed once the new state is ready
+/////////////////////////////////////////////////////////////////////////////////
+void test_reset()
+{
+	nstate_manager manager;
+	check(manager.get() == nullptr, "reset: no state without a state");
+	manager.add(std::unique_ptr<nstate>(new ntest_state(1)), true);
+	manager.process();
+	nstate* first = manager.get();
+	for(int i = 2; i <= 64; i++)
+		manager.add(std::unique_ptr<nstate>(new ntest_state(i)), false);
+	manager.process();
+	check(static_cast<ntest_state*>(first)->_calls == "ip", "reset: get() stays valid while the stack grows");
+
+	std::string game;
+	static_cast<ntest_state*>(manager.get())->_removed = &game;
+	manager.set_frame_cache(sf::Vector2u(8, 8));
+	manager.add(std::unique_ptr<nstate>(new ntest_state(65)), false);
+	manager.process();
+	ntest_state* menu = new ntest_state(66);
+	menu->_ready = false;
+	manager.reset(std::unique_ptr<nstate>(menu));
+	ntransition_report report = manager.report_process();
+	check((report._pending == 1) && (get_id(manager) == 65), "reset: the current state keeps running until the new one is ready");
+
+	menu->_ready = true;
+	report = manager.report_process();
+	check((report._pushed == 1) && (report._removed == 65) && (report._pending == 0), "reset: every state is removed and the new one pushed");
+	check(game == "icp", "reset: the state below is not resumed before it is removed");
+	sf::RenderTexture target;
+	target.create(8, 8);
+	check(!manager.draw_frame(target), "reset: the cached frames are dropped");
+	check((get_id(manager) == 66) && (menu->_calls == "i"), "reset: the new state is initialised");
+	manager.remove();
+	manager.process();
+	check(manager.get() == nullptr, "reset: the new state was the only one");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! nblob: values, strings and literals are read back in order, reading past
+//   the end leaves the value untouched
+/////////////////////////////////////////////////////////////////////////////////
+struct nplain
+{
+	float _x;
+	float _y;
+};
+
+void test_blob()
+{
+	std::vector<char> blob;
+	nplain position = {1.5f, -2.0f};
+	nengine::nstate_manager::nblob_writer(blob).write(42).write(position).write(std::string("name")).write("literal");
+	check(blob.size() == (sizeof(int) + sizeof(nplain) + (2 * sizeof(unsigned int)) + 4 + 7), "blob: no padding or type info");
+
+	nengine::nstate_manager::nblob_reader reader(blob);
+	int number = 0;
+	nplain read = {0.0f, 0.0f};
+	std::string name;
+	std::string literal;
+	check(reader.read(number) && reader.read(read) && reader.read(name) && reader.read(literal), "blob: everything is read back");
+	check((number == 42) && (read._x == 1.5f) && (read._y == -2.0f) && (name == "name") && (literal == "literal"), "blob: the values are equal");
+	number = 7;
+	check((!reader.read(number)) && (number == 7), "blob: reading past the end leaves the value untouched");
+
+	std::vector<char> truncated(blob.begin(), blob.end() - 1);
+	nengine::nstate_manager::nblob_reader short_reader(truncated);
+	check(short_reader.read(number) && short_reader.read(read) && short_reader.read(name), "blob: a truncated blob reads up to the cut");
+	check((!short_reader.read(literal)) && (literal == "literal"), "blob: a cut string is not read");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! set_suspend_depth(): a deeply paused state is written into its blob and
+//   releases its cached frame, the state right below the current one keeps
+//   its frame for draw_frame()
+/////////////////////////////////////////////////////////////////////////////////
+void test_suspend()
+{
+	nstate_manager manager;
+	sf::RenderTexture target;
+	target.create(8, 8);
+	manager.set_frame_cache(sf::Vector2u(8, 8));
+	manager.set_suspend_depth(1);
+	ntest_state* game = new ntest_state(1);
+	ntest_state* menu = new ntest_state(2);
+	game->_suspendable = true;
+	menu->_suspendable = true;
+	manager.add(std::unique_ptr<nstate>(game), true);
+	manager.add(std::unique_ptr<nstate>(menu), false);
+	manager.process();
+	check(game->_calls == "icps", "suspend: the paused state is captured, paused and suspended");
+	check(manager.draw_frame(target), "suspend: the state right below keeps its frame");
+
+	manager.add(std::unique_ptr<nstate>(new ntest_state(3)), false);
+	manager.process();
+	check((menu->_calls == "icps") && manager.draw_frame(target), "suspend: the overlay below is suspended and keeps its frame");
+
+	manager.remove();
+	manager.process();
+	check((menu->_calls == "icpsRr") && menu->_restored, "suspend: the uncovered state is restored from its blob");
+	check(!manager.draw_frame(target), "suspend: the frame of the covered state was released");
+
+	manager.remove();
+	manager.process();
+	check((get_id(manager) == 1) && (game->_calls == "icpsRr") && game->_restored, "suspend: the deepest state is restored from its blob");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! ready(): a state that preloads its resources is not pushed before it is
+//   ready, the current state keeps being handled, updated and drawn meanwhile
+/////////////////////////////////////////////////////////////////////////////////
+void test_ready()
+{
+	nstate_manager manager;
+	ntest_state* menu = new ntest_state(1);
+	manager.add(std::unique_ptr<nstate>(menu), true);
+	manager.process();
+	ntest_state* game = new ntest_state(2);
+	game->_ready = false;
+	manager.add(std::unique_ptr<nstate>(game), true);
+	for(int i = 0; i < 3; i++)
+	{
+		ntransition_report report = manager.report_process();
+		check((report._pushed == 0) && (report._pending == 1) && (get_id(manager) == 1), "ready: a state that is not ready is not pushed");
+		manager.handle();
+		manager.update(0.f);
+		manager.draw(0.f);
+	}
+	check((menu->_calls == "ihudhudhud") && game->_calls.empty(), "ready: the current state keeps running while the next one loads");
+
+	std::string removed;
+	menu->_removed = &removed;
+	game->_ready = true;
+	ntransition_report report = manager.report_process();
+	check((report._pushed == 1) && (report._removed == 1) && (report._pending == 0) && (get_id(manager) == 2), "ready: pushed by the first process() after it is ready");
+	check((removed == "ihudhudhud") && (game->_calls == "i"), "ready: the current state is replaced");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! repeated requests: every add() and remove() is applied, a state that asks
+//   for its successor on every step has to ask only once
+/////////////////////////////////////////////////////////////////////////////////
+void test_repeated()
+{
+	nstate_manager manager;
+	manager.add(std::unique_ptr<nstate>(new ntest_state(1)), true);
+	manager.process();
+	for(int i = 2; i <= 4; i++) // e.g. a splash screen requesting the menu on every step
+		manager.add(std::unique_ptr<nstate>(new ntest_state(i)), true);
+	ntransition_report report = manager.report_process();
+	check((report._pushed == 3) && (report._removed == 3) && (get_id(manager) == 4), "repeated: every replacing add() is applied");
+
+	manager.add(std::unique_ptr<nstate>(new ntest_state(5)), false);
+	manager.add(std::unique_ptr<nstate>(new ntest_state(6)), false);
+	manager.process();
+	manager.remove();
+	manager.remove();
+	report = manager.report_process();
+	check((report._removed == 2) && (get_id(manager) == 4), "repeated: every remove() is applied");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! profiling: every phase is counted per state, a draw() ends a frame, calls
+//   recorded by several threads at once are all kept
+/////////////////////////////////////////////////////////////////////////////////
+void test_profiling()
+{
+	nstate_manager manager;
+	manager.set_profiling(true);
+	manager.add(std::unique_ptr<nstate>(new ntest_state(1)), true);
+	manager.process();
+	for(int frame = 0; frame < 10; frame++)
+	{
+		manager.handle();
+		manager.update(0.f);
+		manager.update(0.f);
+		manager.draw(0.f);
+	}
+	auto stats = manager.get_profile_stats();
+	check((stats.size() == 1) && (stats[0]._name == "ntest_state"), "profiling: the state is profiled by its name");
+	check((stats[0]._handle._calls == 10) && (stats[0]._update._calls == 20) && (stats[0]._draw._calls == 10), "profiling: every call is counted per phase");
+	check(stats[0]._frame._calls == 10, "profiling: a draw() ends a frame");
+
+	std::ostringstream trace;
+	manager.dump_trace(trace, 1);
+	std::string text = trace.str();
+	std::size_t events = 0;
+	for(std::size_t at = text.find("\"ph\":\"X\""); at != std::string::npos; at = text.find("\"ph\":\"X\"", at + 1))
+		events++;
+	check((events == 4) && (text.find("\"frame\":9}") != std::string::npos) && (text.find("\"frame\":8}") == std::string::npos), "profiling: the frame counter advances once per draw()");
+
+	nengine::nstate_manager::nprofiler profiler;
+	std::size_t profile = profiler.get_profile("threads");
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 4; t++)
+	{
+		threads.push_back(std::thread([&profiler, profile]()
+		{
+			auto now = std::chrono::steady_clock::now();
+			for(int i = 0; i < 200; i++)
+				profiler.record(profile, (i % 2) ? nengine::nstate_manager::nphase::DRAW : nengine::nstate_manager::nphase::UPDATE, now, now);
+		}));
+	}
+	for(int i = 0; i < 100; i++)
+		profiler.get_stats();
+	for(auto& thread : threads)
+		thread.join();
+	stats = profiler.get_stats();
+	check((stats[0]._update._calls == 400) && (stats[0]._draw._calls == 400) && (stats[0]._frame._calls == 256), "profiling: no call recorded by several threads is lost");
+	profiler.clr();
+	check(profiler.get_stats()[0]._draw._calls == 0, "profiling: clr() drops every call");
+}
+
+int main()
+{
+	test_async_add();
+	test_async_order();
+	test_frame_cache();
+	test_reset();
+	test_blob();
+	test_suspend();
+	test_ready();
+	test_repeated();
+	test_profiling();
+
+	if(failed == 0)
+		std::cout << "all passed" << std::endl;
+	return failed;
+}
@@ -72,6 +72,22 @@ class nsprite : public sf::Drawable
 			_sprite.setTexture(*_texture);
 			_sprite.setPosition(_position);
 		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: set's internal variables to basic values
+		// @param1: the x coordinate
+		// @param2: the y coordinate
+		// @param3: a shared pointer to the texture, e.g. an atlas page
+		// @param4: the part of the texture to draw
+		/////////////////////////////////////////////////////////////////////////////////
+		nsprite(float x, float y, std::shared_ptr<const sf::Texture> tex, sf::IntRect const& rect)
+			: _position(sf::Vector2f(x, y))
+			, _texture(std::move(tex))
+			, _sprite()
+		{
+			_sprite.setTexture(*_texture);
+			_sprite.setTextureRect(rect);
+			_sprite.setPosition(_position);
+		}
 		////////////////////////////////////////////////////////////////////////////////
 		// ! to access the internal sprite for drawing
 		// @return: returns the internal sprite by reference
@@ -194,6 +210,23 @@ class nlayer : public sf::Drawable
 			} // lock freed
 		}
 		/////////////////////////////////////////////////////////////////////////////////
+		// ! adds a sf::Sprite drawing a part of a texture to the list of items in
+		//   this layer, sprites sharing an atlas page are drawn without texture switch
+		// @param1: the key identifier
+		// @param2: the x coordinate
+		// @param3: the y coordinate
+		// @param4: a shared pointer to a SFML texture
+		// @param5: the part of the texture to draw
+		/////////////////////////////////////////////////////////////////////////////////
+		auto add_sprite(std::string const& key, float x, float y, std::shared_ptr<const sf::Texture> tex, sf::IntRect const& rect) -> void
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				auto tmp = std::make_shared<nsprite>(x, y, tex, rect);
+				_nsprites.insert(std::make_pair(key, tmp));
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
 		// ! adds a sf::Text to the list of items in this layer
 		// @param1: the key identifier
 		// @param2: the x coordinate
@@ -0,0 +1,606 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+// NEngine C++ Library
+// Copyright (c) 2017-2017 Sebastian Netsch
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NENGINE__NRUN_LOOP__NRUN_LOOP__
+#define __NENGINE__NRUN_LOOP__NRUN_LOOP__
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! atomic for the running indicator, the settings and the stats
+// ! chrono for the fixed steps and the frame pacing
+// ! exception for handing simulation errors to the render thread
+// ! functional for the step and draw functions
+// ! memory for shared pointers to the snapshots
+// ! mutex for thread safety
+// ! thread for the simulation thread
+/////////////////////////////////////////////////////////////////////////////////
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the longest frame time that is simulated at once in seconds, longer frames
+//   are cut so a stall does not end in a spiral of catch up steps
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NRUN_LOOP_MAX_FRAME_TIME
+#define NRUN_LOOP_MAX_FRAME_TIME 0.25f
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the default amount of fixed steps run at once, the rest of a stall is
+//   dropped instead of bursting through it
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NRUN_LOOP_MAX_STEPS
+#define NRUN_LOOP_MAX_STEPS 5
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the default time in microseconds that is spun instead of slept before a
+//   deadline, since a sleep may overshoot by about a scheduler tick
+/////////////////////////////////////////////////////////////////////////////////
+#ifndef NRUN_LOOP_SPIN
+#define NRUN_LOOP_SPIN 1000
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nengine
+/////////////////////////////////////////////////////////////////////////////////
+namespace nengine {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace for the nrun_loop
+/////////////////////////////////////////////////////////////////////////////////
+namespace nrun_loop {
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! namespace using for easier and cleaner programming
+/////////////////////////////////////////////////////////////////////////////////
+using namespace nengine;
+using namespace nengine::nrun_loop;
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! where the fixed steps of a nrun_loop run
+// ! SINGLE: on the render thread inside render(), the classic accumulator loop
+// ! THREADED: on an own simulation thread, render() only draws
+/////////////////////////////////////////////////////////////////////////////////
+enum class nrun_mode
+{
+	SINGLE,
+	THREADED
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! struct nrun_stats to report the pacing of a nrun_loop
+// ! _frames: rendered frames
+// ! _steps: fixed steps run
+// ! _dropped: fixed steps dropped by the max steps policy
+// ! _merged: advances that ran more than one fixed step at once
+// ! _late: frames that missed the target frame rate
+// ! _frame_time: the time between the last two rendered frames in seconds
+/////////////////////////////////////////////////////////////////////////////////
+struct nrun_stats
+{
+	unsigned long long _frames;
+	unsigned long long _steps;
+	unsigned long long _dropped;
+	unsigned long long _merged;
+	unsigned long long _late;
+	float _frame_time;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! interpolates between two snapshot values
+// @param1: the value of the previous snapshot
+// @param2: the value of the current snapshot
+// @param3: the alpha handed to the draw function
+// @return: the value in between
+/////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+auto nlerp(T const& from, T const& to, float alpha) -> T
+{
+	return (from + ((to - from) * alpha));
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! the nrun_loop
+// ! simulates at a fixed rate and publishes an immutable SNAPSHOT after every
+//   step, the render thread draws between the last two of them
+// ! SNAPSHOT has to be default constructible
+/////////////////////////////////////////////////////////////////////////////////
+template <typename SNAPSHOT>
+class nrun_loop
+{
+	public:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete default constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nrun_loop(const nrun_loop&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! delete copy constructor
+		/////////////////////////////////////////////////////////////////////////////////
+		nrun_loop& operator=(const nrun_loop&) = delete;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom constructor: with initialization list
+		// @param1: the fixed step in seconds
+		// @param2: where the fixed steps run
+		/////////////////////////////////////////////////////////////////////////////////
+		nrun_loop(float dt, nrun_mode mode = nrun_mode::THREADED)
+			: _dt(dt)
+			, _mode(mode)
+			, _step()
+			, _mutex()
+			, _previous()
+			, _current()
+			, _spare()
+			, _published()
+			, _error()
+			, _running(false)
+			, _thread()
+			, _accumulator(0.0f)
+			, _last()
+			, _max_steps(NRUN_LOOP_MAX_STEPS)
+			, _frame_rate(0)
+			, _spin(NRUN_LOOP_SPIN)
+			, _smoothing(0.0f)
+			, _smoothed(0.0f)
+			, _paced()
+			, _rendered()
+			, _frames(0)
+			, _steps(0)
+			, _dropped(0)
+			, _merged(0)
+			, _late(0)
+			, _frame_time(0.0f)
+		{
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! custom destructor: stops the simulation thread
+		/////////////////////////////////////////////////////////////////////////////////
+		~nrun_loop()
+		{
+			stop();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! starts the simulation, a running one is stopped first
+		// @param1: called once per fixed step with the step in seconds and the
+		//          snapshot to fill, the snapshot holds an older state and has to be
+		//          written completely
+		/////////////////////////////////////////////////////////////////////////////////
+		auto start(std::function<void(float, SNAPSHOT&)> step) -> void
+		{
+			stop();
+			_step = std::move(step);
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				_previous.reset();
+				_current.reset();
+				_spare.reset();
+				_error = nullptr;
+			} // lock freed
+			_accumulator = 0.0f;
+			_smoothed = 0.0f;
+			_last = std::chrono::steady_clock::now();
+			_running = true;
+			if(_mode == nrun_mode::THREADED)
+			{
+				_thread = std::thread(&nrun_loop::_simulate, this);
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! stops the simulation and waits for the simulation thread
+		/////////////////////////////////////////////////////////////////////////////////
+		auto stop() -> void
+		{
+			_running = false;
+			if(_thread.joinable())
+			{
+				_thread.join();
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to find out if the simulation is running
+		// @return: false before start(), after stop() or after a step threw
+		/////////////////////////////////////////////////////////////////////////////////
+		auto is_running() const -> bool
+		{
+			return _running;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! draws between the last two published snapshots, called once per frame on
+		//   the render thread
+		// ! in SINGLE mode the due fixed steps run first
+		// ! an exception thrown by a step on the simulation thread is rethrown here
+		// @param1: called with the previous snapshot, the current snapshot and the
+		//          alpha, the part of a step that passed since the current snapshot
+		//          was published (0 to 1)
+		// @return: false if no snapshot was published yet
+		/////////////////////////////////////////////////////////////////////////////////
+		auto render(std::function<void(SNAPSHOT const&, SNAPSHOT const&, float)> const& draw) -> bool
+		{
+			auto now = std::chrono::steady_clock::now();
+			if(_rendered != std::chrono::steady_clock::time_point())
+			{
+				_frame_time = std::chrono::duration<float>(now - _rendered).count();
+			}
+			_rendered = now;
+			_frames++;
+			if((_mode == nrun_mode::SINGLE) && (_running))
+			{
+				_advance();
+			}
+			std::shared_ptr<const SNAPSHOT> previous;
+			std::shared_ptr<const SNAPSHOT> current;
+			std::chrono::steady_clock::time_point published;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if(_error != nullptr)
+				{
+					auto error = _error;
+					_error = nullptr;
+					std::rethrow_exception(error);
+				}
+				previous = _previous;
+				current = _current;
+				published = _published;
+			} // lock freed
+			lock.unlock();
+			if(current == nullptr)
+			{
+				return false;
+			}
+			if(previous == nullptr)
+			{
+				previous = current;
+			}
+			float alpha = 0.0f;
+			if(_mode == nrun_mode::SINGLE)
+			{
+				alpha = (_accumulator / _dt);
+			}
+			else
+			{
+				alpha = (std::chrono::duration<float>(std::chrono::steady_clock::now() - published).count() / _dt);
+			}
+			draw(*previous, *current, ((alpha < 1.0f) ? alpha : 1.0f));
+			lock.lock();
+			{ // locked area
+				previous.reset();
+				current.reset();
+			} // lock freed
+			return true;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! waits until the next frame is due, called once per frame on the render
+		//   thread after displaying it
+		// ! sleeps until shortly before the deadline and spins the rest, a frame that
+		//   is already late does not wait and restarts the pacing
+		// ! does nothing without a target frame rate, e.g. with vsync
+		/////////////////////////////////////////////////////////////////////////////////
+		auto pace() -> void
+		{
+			unsigned int frame_rate = _frame_rate;
+			if(frame_rate == 0)
+			{
+				return;
+			}
+			auto now = std::chrono::steady_clock::now();
+			if(_paced == std::chrono::steady_clock::time_point())
+			{
+				_paced = now;
+			}
+			_paced += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / frame_rate));
+			if(_paced < now)
+			{
+				_late++;
+				_paced = now;
+				return;
+			}
+			_wait_until(_paced);
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the amount of fixed steps run at once, after a stall the steps beyond
+		//   it are dropped instead of run in a burst
+		// @param1: the amount of steps, 0 runs every due step
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_max_steps(unsigned int steps) -> void
+		{
+			_max_steps = steps;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the frame rate pace() waits for
+		// @param1: the frames per second, 0 disables the pacing
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_frame_rate(unsigned int frame_rate) -> void
+		{
+			_frame_rate = frame_rate;
+			_paced = std::chrono::steady_clock::time_point();
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets how long before a deadline the waiting spins instead of sleeping,
+		//   more spinning hits the deadline closer for more cpu time
+		// @param1: the spinning time in microseconds, 0 only sleeps, e.g. on battery
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_spin(unsigned int microseconds) -> void
+		{
+			_spin = microseconds;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sets the smoothing of the measured frame times, a smoothed frame time
+		//   evens out the jitter of the timer and the scheduler
+		// @param1: the weight of the previous frame times from 0 (disabled) to below 1
+		/////////////////////////////////////////////////////////////////////////////////
+		auto set_smoothing(float smoothing) -> void
+		{
+			_smoothing = smoothing;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the pacing counters
+		// @return: the rendered frames, the run, dropped and merged steps, the late
+		//          frames and the last frame time
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_stats() const -> nrun_stats
+		{
+			nrun_stats stats;
+			stats._frames = _frames;
+			stats._steps = _steps;
+			stats._dropped = _dropped;
+			stats._merged = _merged;
+			stats._late = _late;
+			stats._frame_time = _frame_time;
+			return stats;
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the last published snapshot, e.g. for reading it outside of render()
+		// @return: the current snapshot, nullptr if none was published yet
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_current() -> std::shared_ptr<const SNAPSHOT>
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				return _current;
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! to get the fixed step
+		// @return: the fixed step in seconds
+		/////////////////////////////////////////////////////////////////////////////////
+		auto get_dt() const -> float
+		{
+			return _dt;
+		}
+	private:
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the fixed step in seconds
+		/////////////////////////////////////////////////////////////////////////////////
+		const float _dt;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! where the fixed steps run
+		/////////////////////////////////////////////////////////////////////////////////
+		const nrun_mode _mode;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the function filling a snapshot once per fixed step
+		/////////////////////////////////////////////////////////////////////////////////
+		std::function<void(float, SNAPSHOT&)> _step;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! for thread safety of the published snapshots
+		/////////////////////////////////////////////////////////////////////////////////
+		std::mutex _mutex;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the snapshot published before the current one
+		/////////////////////////////////////////////////////////////////////////////////
+		std::shared_ptr<SNAPSHOT> _previous;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the last published snapshot
+		/////////////////////////////////////////////////////////////////////////////////
+		std::shared_ptr<SNAPSHOT> _current;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the snapshot that dropped out, reused by the next step once the render
+		//   thread let go of it so a step does not allocate
+		// ! render() lets go of its snapshots under _mutex, so the step only writes
+		//   a snapshot after the draw function is done reading it
+		/////////////////////////////////////////////////////////////////////////////////
+		std::shared_ptr<SNAPSHOT> _spare;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! when the current snapshot was published
+		/////////////////////////////////////////////////////////////////////////////////
+		std::chrono::steady_clock::time_point _published;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! an exception thrown by a step on the simulation thread
+		/////////////////////////////////////////////////////////////////////////////////
+		std::exception_ptr _error;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! if the simulation is running
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<bool> _running;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the simulation thread, only used in THREADED mode
+		/////////////////////////////////////////////////////////////////////////////////
+		std::thread _thread;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the time that is not simulated yet in seconds, only used by the thread
+		//   running the steps
+		/////////////////////////////////////////////////////////////////////////////////
+		float _accumulator;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! when the steps were advanced the last time, only used by the thread
+		//   running the steps
+		/////////////////////////////////////////////////////////////////////////////////
+		std::chrono::steady_clock::time_point _last;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the amount of fixed steps run at once, 0 for no limit
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<unsigned int> _max_steps;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the frame rate pace() waits for, 0 if pacing is disabled
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<unsigned int> _frame_rate;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the time spun before a deadline in microseconds
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<unsigned int> _spin;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the weight of the previous frame times, 0 if smoothing is disabled
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<float> _smoothing;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the smoothed frame time in seconds, only used by the thread running the
+		//   steps
+		/////////////////////////////////////////////////////////////////////////////////
+		float _smoothed;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the deadline of the current frame, only used by the render thread
+		/////////////////////////////////////////////////////////////////////////////////
+		std::chrono::steady_clock::time_point _paced;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! when the last frame was rendered, only used by the render thread
+		/////////////////////////////////////////////////////////////////////////////////
+		std::chrono::steady_clock::time_point _rendered;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the pacing counters
+		/////////////////////////////////////////////////////////////////////////////////
+		std::atomic<unsigned long long> _frames;
+		std::atomic<unsigned long long> _steps;
+		std::atomic<unsigned long long> _dropped;
+		std::atomic<unsigned long long> _merged;
+		std::atomic<unsigned long long> _late;
+		std::atomic<float> _frame_time;
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! runs the steps that are due since the last call
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _advance() -> void
+		{
+			auto now = std::chrono::steady_clock::now();
+			float frame_time = std::chrono::duration<float>(now - _last).count();
+			_last = now;
+			if(frame_time > NRUN_LOOP_MAX_FRAME_TIME)
+			{
+				frame_time = NRUN_LOOP_MAX_FRAME_TIME;
+			}
+			float smoothing = _smoothing;
+			if(smoothing > 0.0f)
+			{
+				_smoothed = ((_smoothed > 0.0f) ? ((_smoothed * smoothing) + (frame_time * (1.0f - smoothing))) : frame_time);
+				frame_time = _smoothed;
+			}
+			_accumulator += frame_time;
+			unsigned int max_steps = _max_steps;
+			unsigned int steps = 0;
+			while(_accumulator >= _dt)
+			{
+				if((max_steps > 0) && (steps == max_steps))
+				{
+					unsigned int dropped = static_cast<unsigned int>(_accumulator / _dt);
+					_dropped += dropped;
+					_accumulator -= (dropped * _dt);
+					break;
+				}
+				_tick();
+				_accumulator -= _dt;
+				steps++;
+			}
+			_steps += steps;
+			if(steps > 1)
+			{
+				_merged++;
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! runs a single step and publishes its snapshot
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _tick() -> void
+		{
+			std::shared_ptr<SNAPSHOT> next;
+			std::unique_lock<std::mutex> lock(_mutex);
+			{ // locked area
+				if((_spare != nullptr) && (_spare.use_count() == 1))
+				{
+					// use_count() is a relaxed read, the fence orders the reads of the
+					// last other owner before the step writes the snapshot again
+					std::atomic_thread_fence(std::memory_order_acquire);
+					next = std::move(_spare);
+				}
+			} // lock freed
+			lock.unlock();
+			if(next == nullptr)
+			{
+				next = std::make_shared<SNAPSHOT>();
+			}
+			_step(_dt, *next);
+			lock.lock();
+			{ // locked area
+				_spare = std::move(_previous);
+				_previous = std::move(_current);
+				_current = std::move(next);
+				_published = std::chrono::steady_clock::now();
+			} // lock freed
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! sleeps until shortly before a deadline and spins the rest
+		// @param1: the deadline
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _wait_until(std::chrono::steady_clock::time_point deadline) -> void
+		{
+			auto spin = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::microseconds(_spin.load()));
+			if((deadline - std::chrono::steady_clock::now()) > spin)
+			{
+				std::this_thread::sleep_until(deadline - spin);
+			}
+			while(std::chrono::steady_clock::now() < deadline)
+			{
+				std::this_thread::yield();
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////////////
+		// ! the simulation thread, waits until the next step is due
+		/////////////////////////////////////////////////////////////////////////////////
+		auto _simulate() -> void
+		{
+			try
+			{
+				while(_running)
+				{
+					_advance();
+					_wait_until(_last + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(_dt - _accumulator)));
+				}
+			}
+			catch(...)
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				{ // locked area
+					_error = std::current_exception();
+				} // lock freed
+				_running = false;
+			}
+		}
+}; // end of class nrun_loop
+
+} // end of namespace nrun_loop
+
+} // end of namespace nengine
+
+#endif // end of __NENGINE__NRUN_LOOP__NRUN_LOOP__
@@ -0,0 +1,217 @@
+#include "../nrun_loop.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! headless test: the snapshots only hold numbers, no window is opened
+/////////////////////////////////////////////////////////////////////////////////
+using nengine::nrun_loop::nrun_loop;
+using nengine::nrun_loop::nrun_stats;
+
+int failed = 0;
+
+void check(bool condition, char const* name)
+{
+	std::cout << (condition ? "ok      " : "FAILED  ") << name << std::endl;
+	if(!condition)
+		failed++;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! a snapshot every value of which is written by the same step, a draw that
+//   sees different values read it while the step wrote it again
+/////////////////////////////////////////////////////////////////////////////////
+std::atomic<int> snapshots(0);
+
+struct nsnapshot
+{
+	nsnapshot() {snapshots++;}
+	unsigned long long _values[256];
+};
+
+auto is_whole(nsnapshot const& snapshot) -> bool
+{
+	for(unsigned long long value : snapshot._values)
+	{
+		if(value != snapshot._values[0])
+			return false;
+	}
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! THREADED: the draw function never sees a snapshot the step is writing, the
+//   spare snapshot is reused instead of allocating one per step
+/////////////////////////////////////////////////////////////////////////////////
+void test_threaded()
+{
+	nrun_loop<nsnapshot> run_loop(0.0005f);
+	unsigned long long step = 0;
+	run_loop.start([&step](float, nsnapshot& next)
+	{
+		step++;
+		for(unsigned long long& value : next._values)
+			value = step;
+	});
+
+	bool whole = true;
+	bool ordered = true;
+	bool alpha = true;
+	unsigned int drawn = 0;
+	auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+	while(std::chrono::steady_clock::now() < end)
+	{
+		bool rendered = run_loop.render([&](nsnapshot const& previous, nsnapshot const& current, float a)
+		{
+			whole = whole && is_whole(previous) && is_whole(current);
+			ordered = ordered && (previous._values[0] <= current._values[0]);
+			alpha = alpha && (a >= 0.0f) && (a <= 1.0f);
+		});
+		if(rendered)
+			drawn++;
+	}
+	run_loop.stop();
+
+	nrun_stats stats = run_loop.get_stats();
+	std::cout << "        " << stats._steps << " steps, " << drawn << " frames drawn, " << snapshots << " snapshots allocated" << std::endl;
+	check(drawn > 0, "threaded: snapshots are drawn");
+	check(whole, "threaded: no snapshot is written while it is drawn");
+	check(ordered, "threaded: the previous snapshot is older than the current one");
+	check(alpha, "threaded: the alpha stays between 0 and 1");
+	check((stats._steps > 10) && (static_cast<unsigned long long>(snapshots) < stats._steps), "threaded: the spare snapshot is reused");
+	check(!run_loop.is_running(), "threaded: stopped");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! THREADED: an exception of a step stops the simulation and is rethrown by
+//   render()
+/////////////////////////////////////////////////////////////////////////////////
+void test_error()
+{
+	nrun_loop<nsnapshot> run_loop(0.001f);
+	run_loop.start([](float, nsnapshot&)
+	{
+		throw 7;
+	});
+	while(run_loop.is_running())
+		std::this_thread::yield();
+	bool caught = false;
+	try
+	{
+		run_loop.render([](nsnapshot const&, nsnapshot const&, float) {});
+	}
+	catch(int error)
+	{
+		caught = (error == 7);
+	}
+	check(caught, "error: the exception of the step is rethrown by render()");
+	check(!run_loop.render([](nsnapshot const&, nsnapshot const&, float) {}), "error: nothing is drawn without a snapshot");
+}
+
+void draw_nothing(nsnapshot const&, nsnapshot const&, float)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! SINGLE: a stall runs at most the max steps and drops the rest, without a
+//   limit it is still cut at NRUN_LOOP_MAX_FRAME_TIME
+/////////////////////////////////////////////////////////////////////////////////
+void test_max_steps()
+{
+	nrun_loop<nsnapshot> run_loop(0.01f, nengine::nrun_loop::nrun_mode::SINGLE);
+	run_loop.start([](float, nsnapshot&) {});
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	run_loop.render(draw_nothing);
+	nrun_stats stats = run_loop.get_stats();
+	std::cout << "        100 ms stall: " << stats._steps << " steps, " << stats._dropped << " dropped" << std::endl;
+	check(stats._steps == NRUN_LOOP_MAX_STEPS, "max steps: a stall runs the max steps");
+	check(stats._dropped >= 5, "max steps: the rest of the stall is dropped");
+	check(stats._merged == 1, "max steps: the burst is counted as merged");
+
+	run_loop.set_max_steps(0);
+	std::this_thread::sleep_for(std::chrono::milliseconds(400));
+	run_loop.render(draw_nothing);
+	unsigned long long steps = (run_loop.get_stats()._steps - stats._steps);
+	std::cout << "        400 ms stall without a limit: " << steps << " steps" << std::endl;
+	check((steps >= 20) && (steps <= 25), "max steps: without a limit the frame time is cut at 0.25 s");
+	run_loop.stop();
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! SINGLE: the smoothing spreads a single stall over the following frames
+/////////////////////////////////////////////////////////////////////////////////
+void test_smoothing()
+{
+	unsigned long long stalled[2] = {0, 0};
+	for(int smoothed = 0; smoothed < 2; smoothed++)
+	{
+		nrun_loop<nsnapshot> run_loop(0.001f, nengine::nrun_loop::nrun_mode::SINGLE);
+		run_loop.set_max_steps(0);
+		run_loop.set_smoothing(smoothed ? 0.9f : 0.0f);
+		run_loop.start([](float, nsnapshot&) {});
+		for(int i = 0; i < 20; i++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			run_loop.render(draw_nothing);
+		}
+		unsigned long long steps = run_loop.get_stats()._steps;
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		run_loop.render(draw_nothing);
+		stalled[smoothed] = (run_loop.get_stats()._steps - steps);
+		run_loop.stop();
+	}
+	std::cout << "        50 ms stall: " << stalled[0] << " steps, smoothed " << stalled[1] << " steps" << std::endl;
+	check(stalled[1] < (stalled[0] / 2), "smoothing: a stall is spread over the following frames");
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// ! pace(): never returns before the deadline, a late frame restarts the
+//   pacing, sleeping only trades accuracy for cpu time
+/////////////////////////////////////////////////////////////////////////////////
+void test_pacing()
+{
+	for(unsigned int spin = 0; spin < 2; spin++)
+	{
+		nrun_loop<nsnapshot> run_loop(0.01f, nengine::nrun_loop::nrun_mode::SINGLE);
+		run_loop.set_frame_rate(200);
+		run_loop.set_spin(spin ? NRUN_LOOP_SPIN : 0);
+		run_loop.start([](float, nsnapshot&) {});
+		run_loop.pace();
+		auto start = std::chrono::steady_clock::now();
+		for(int i = 0; i < 40; i++)
+		{
+			run_loop.render(draw_nothing);
+			run_loop.pace();
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "        40 frames at 200 fps, " << (spin ? "spinning: " : "sleeping only: ") << ms << " ms" << std::endl;
+		check(ms >= 199.0, spin ? "pacing: spinning never returns early" : "pacing: sleeping never returns early");
+		check(ms < 300.0, spin ? "pacing: spinning keeps the frame rate" : "pacing: sleeping keeps the frame rate");
+
+		unsigned long long late = run_loop.get_stats()._late;
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		run_loop.pace();
+		start = std::chrono::steady_clock::now();
+		run_loop.pace();
+		double restarted = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		check(run_loop.get_stats()._late == (late + 1), "pacing: a late frame is counted and does not wait");
+		check((restarted >= 4.9) && (restarted < 15.0), "pacing: the next frame waits a whole frame again");
+		run_loop.stop();
+	}
+}
+
+int main()
+{
+	test_threaded();
+	test_error();
+	test_max_steps();
+	test_smoothing();
+	test_pacing();
+
+	if(failed == 0)
+		std::cout << "all passed" << std::endl;
+	return failed;
+}